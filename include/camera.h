@@ -5,6 +5,8 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "frustum.h"
+
 enum class MovementDirection {
     Forward,
     Backward,
@@ -68,13 +70,40 @@ public:
     }
 };
 
+/**
+ * Where a camera is and where it looks, yaw and pitch in degrees as in Camera::rotate.
+ */
+struct CameraPose {
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+};
+
+// the pose t of the way from a to b, turning the short way round where yaw wraps at 360
+inline CameraPose interpolate(const CameraPose& a, const CameraPose& b, float t) {
+    float yawDelta = glm::mod(b.yaw - a.yaw + 540.0f, 360.0f) - 180.0f;
+    return CameraPose{glm::mix(a.position, b.position, t), a.yaw + yawDelta * t, glm::mix(a.pitch, b.pitch, t)};
+}
+
+/**
+ * A free flying camera. The matrices, frustum and basis vectors are cached and only recomputed after
+ * move, rotate, setZoom or a different aspect ratio has changed them, so reading them several times
+ * per frame costs nothing. The getters update the cache, a Camera can't be shared between threads.
+ */
 class Camera {
 private:
     glm::vec3 position_{0.0f, 0.0f, 0.0f};
     glm::vec3 worldUp_{0.0f, 1.0f, 0.0f};
     glm::vec3 worldForward_{0.0f, 0.0f, -1.0f};
+    // need to use -worldForward since we define it as -ve conventionally
+    glm::vec3 worldRight_ = glm::normalize(glm::cross(worldUp_, -worldForward_));
     glm::quat orientation_;
 
+    // orientation_ applied to the world vectors, updated with it
+    glm::vec3 forward_{0.0f, 0.0f, -1.0f};
+    glm::vec3 up_{0.0f, 1.0f, 0.0f};
+    glm::vec3 right_{1.0f, 0.0f, 0.0f};
+
     // defined w.r.t. Cameras local right vector and worldUp vector.
     // stored in degrees, clamped in range [-89.0f, 89.0f].
     float pitch_ = 0.0f;
@@ -84,7 +113,25 @@ private:
 
     float sensitivity_ = 0.07f;
     float speed_ = 5.0f;
+    // vertical field of view, in degrees
     float zoom_ = 45.0f;
+    float nearPlane_ = 0.1f;
+    float farPlane_ = 100.0f;
+
+    // cached matrices, the view ones depend on position and orientation, the projection on zoom and aspect ratio
+    mutable glm::mat4 view_{1.0f};
+    mutable glm::mat4 inverseView_{1.0f};
+    mutable glm::mat4 projection_{1.0f};
+    mutable glm::mat4 viewProjection_{1.0f};
+    mutable glm::mat4 inverseViewProjection_{1.0f};
+    mutable Frustum frustum_{};
+    mutable float cachedAspectRatio_ = 0.0f;
+    mutable bool viewDirty_ = true;
+    mutable bool projectionDirty_ = true;
+    // view projection, its inverse and the frustum, whenever either of the above changed
+    mutable bool viewProjectionDirty_ = true;
+    mutable bool inverseViewProjectionDirty_ = true;
+    mutable bool frustumDirty_ = true;
 
 public:
     Camera() {
@@ -113,23 +160,69 @@ public:
     Camera(glm::vec3 position, glm::vec3 direction, glm::vec3 worldUp, glm::vec3 worldForward)
         : position_(position),
           worldUp_(glm::normalize(worldUp)),
-          worldForward_(glm::normalize(worldForward))
+          worldForward_(glm::normalize(worldForward)),
+          worldRight_(glm::normalize(glm::cross(worldUp_, -worldForward_)))
     {
         updateOrientation(glm::normalize(direction));
     }
 
-    glm::mat4 getViewMatrix() const {
-        glm::mat4 rotation = glm::mat4_cast(glm::conjugate(orientation_));
-        glm::mat4 translation = glm::translate(glm::mat4(1.0f), -position_);
-        return rotation * translation;
+    const glm::mat4& getViewMatrix() const {
+        if (viewDirty_) {
+            glm::mat4 rotation = glm::mat4_cast(glm::conjugate(orientation_));
+            glm::mat4 translation = glm::translate(glm::mat4(1.0f), -position_);
+            view_ = rotation * translation;
+            // the view is a rigid transform, its inverse is the camera's placement in the world
+            inverseView_ = glm::translate(glm::mat4(1.0f), position_) * glm::mat4_cast(orientation_);
+            viewDirty_ = false;
+        }
+        return view_;
     }
 
-    glm::mat4 getProjectionMatrix(float aspectRatio) const {
-        return glm::perspective(glm::radians(zoom_), aspectRatio, 0.1f, 100.0f);
+    // camera to world space
+    const glm::mat4& getInverseViewMatrix() const {
+        getViewMatrix();
+        return inverseView_;
     }
 
-    glm::mat4 getViewProjectionMatrix(float aspectRatio) const {
-        return getProjectionMatrix(aspectRatio) * getViewMatrix();
+    const glm::mat4& getProjectionMatrix(float aspectRatio) const {
+        if (aspectRatio != cachedAspectRatio_) {
+            cachedAspectRatio_ = aspectRatio;
+            invalidateProjection();
+        }
+        if (projectionDirty_) {
+            projection_ = glm::perspective(glm::radians(zoom_), aspectRatio, nearPlane_, farPlane_);
+            projectionDirty_ = false;
+        }
+        return projection_;
+    }
+
+    const glm::mat4& getViewProjectionMatrix(float aspectRatio) const {
+        const glm::mat4& projection = getProjectionMatrix(aspectRatio);
+        if (viewProjectionDirty_) {
+            viewProjection_ = projection * getViewMatrix();
+            viewProjectionDirty_ = false;
+        }
+        return viewProjection_;
+    }
+
+    // clip to world space, e.g. to unproject screen positions
+    const glm::mat4& getInverseViewProjectionMatrix(float aspectRatio) const {
+        const glm::mat4& viewProjection = getViewProjectionMatrix(aspectRatio);
+        if (inverseViewProjectionDirty_) {
+            inverseViewProjection_ = glm::inverse(viewProjection);
+            inverseViewProjectionDirty_ = false;
+        }
+        return inverseViewProjection_;
+    }
+
+    // world space planes of what the camera sees, for culling with FrustumCulling
+    const Frustum& getFrustum(float aspectRatio) const {
+        const glm::mat4& viewProjection = getViewProjectionMatrix(aspectRatio);
+        if (frustumDirty_) {
+            frustum_ = Frustum::fromViewProjection(viewProjection);
+            frustumDirty_ = false;
+        }
+        return frustum_;
     }
     
     glm::vec3 getPosition() const {
@@ -140,22 +233,76 @@ public:
         return getCameraForward();
     }
 
+    // vertical field of view of the projection, in degrees
+    float getZoom() const {
+        return zoom_;
+    }
+
+    // in degrees, see rotate
+    float getYaw() const {
+        return yaw_;
+    }
+
+    float getPitch() const {
+        return pitch_;
+    }
+
+    CameraPose getPose() const {
+        return CameraPose{position_, yaw_, pitch_};
+    }
+
+    // places the camera directly, e.g. from a recorded path
+    void setPose(const CameraPose& pose) {
+        float yaw = glm::mod(pose.yaw, 360.0f);
+        float pitch = glm::clamp(pose.pitch, -89.0f, 89.0f);
+        if (pose.position == position_ && yaw == yaw_ && pitch == pitch_) {
+            return;
+        }
+        position_ = pose.position;
+        yaw_ = yaw;
+        pitch_ = pitch;
+        updateOrientation();
+    }
+
+    void setZoom(float zoom) {
+        if (zoom != zoom_) {
+            zoom_ = zoom;
+            invalidateProjection();
+        }
+    }
+
+    float getNearPlane() const {
+        return nearPlane_;
+    }
+
+    float getFarPlane() const {
+        return farPlane_;
+    }
+
     void move(const CameraMovement& movement, float deltaTime) {
+        glm::vec3 direction = movement.getMovement();
+        if (direction == glm::vec3(0.0f) || deltaTime == 0.0f) {
+            return;
+        }
         float distance = speed_ * deltaTime;
 
-        position_ += getCameraForward() * movement.getForwardMovement() * distance;
-        position_ += getCameraRight() * movement.getRightMovement() * distance;
-        position_ += getCameraUp() * movement.getUpMovement() * distance;
+        position_ += forward_ * direction.z * distance;
+        position_ += right_ * direction.x * distance;
+        position_ += up_ * direction.y * distance;
+        invalidateView();
     }
 
     void rotate(float deltaYaw, float deltaPitch) {
         deltaYaw *= sensitivity_;
         deltaPitch *= sensitivity_;
 
-        yaw_ = glm::mod(yaw_ - deltaYaw, 360.0f);
-        
-        pitch_ += deltaPitch;
-        pitch_ = glm::clamp(pitch_, -89.0f, 89.0f);
+        float yaw = glm::mod(yaw_ - deltaYaw, 360.0f);
+        float pitch = glm::clamp(pitch_ + deltaPitch, -89.0f, 89.0f);
+        if (yaw == yaw_ && pitch == pitch_) {
+            return;
+        }
+        yaw_ = yaw;
+        pitch_ = pitch;
 
         updateOrientation();
     }
@@ -163,17 +310,29 @@ public:
 private:
 
     glm::vec3 getCameraForward() const {
-        return glm::normalize(orientation_ * worldForward_);
+        return forward_;
     }
 
     glm::vec3 getCameraUp() const {
-        return glm::normalize(orientation_ * worldUp_);
+        return up_;
     }
 
     glm::vec3 getCameraRight() const {
-        // need to use -worldForward since we define it as -ve conventionally
-        glm::vec3 worldRight = glm::normalize(glm::cross(worldUp_, -worldForward_));
-        return glm::normalize(orientation_ * worldRight);
+        return right_;
+    }
+
+    void invalidateView() const {
+        viewDirty_ = true;
+        viewProjectionDirty_ = true;
+        inverseViewProjectionDirty_ = true;
+        frustumDirty_ = true;
+    }
+
+    void invalidateProjection() const {
+        projectionDirty_ = true;
+        viewProjectionDirty_ = true;
+        inverseViewProjectionDirty_ = true;
+        frustumDirty_ = true;
     }
 
     /**
@@ -190,9 +349,8 @@ private:
     void setYaw(glm::vec3 direction) {
         // projection onto plane spanned by worldFoward and worldRight
         glm::vec3 projection = direction - glm::dot(direction, worldUp_);
-        glm::vec3 worldRight = glm::normalize(glm::cross(worldUp_, -worldForward_));
         float rawYaw = glm::degrees(glm::atan(
-            glm::dot(projection, -worldRight),
+            glm::dot(projection, -worldRight_),
             glm::dot(projection, worldForward_)
         ));
         yaw_ = glm::mod(rawYaw, 360.0f);
@@ -201,8 +359,14 @@ private:
     void updateOrientation() {
         // reset orientation to the yaw rotation
         orientation_ = glm::normalize(glm::angleAxis(glm::radians(yaw_), worldUp_));
-        // then apply the pitch rotation
-        orientation_ = glm::normalize(glm::angleAxis(glm::radians(pitch_), getCameraRight()) * orientation_);
+        // then apply the pitch rotation, around the right vector of the yawed camera
+        glm::vec3 yawedRight = glm::normalize(orientation_ * worldRight_);
+        orientation_ = glm::normalize(glm::angleAxis(glm::radians(pitch_), yawedRight) * orientation_);
+
+        forward_ = glm::normalize(orientation_ * worldForward_);
+        up_ = glm::normalize(orientation_ * worldUp_);
+        right_ = glm::normalize(orientation_ * worldRight_);
+        invalidateView();
     }
 
     /**
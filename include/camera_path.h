@@ -0,0 +1,256 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "camera.h"
+#include "mapped_file.h"
+
+/**
+ * The camera's state at one moment of a recorded fly-through, time in seconds since the recording started.
+ */
+struct CameraPathSample {
+    float time;
+    CameraPose pose;
+};
+
+/**
+ * Camera path files, written by CameraPathRecorder and read by CameraPath.
+ * File layout (native endianness): FileHeader | CameraPathSample... in increasing time.
+ */
+namespace CameraPathFile {
+    inline constexpr uint32_t version = 1;
+    inline constexpr char magic[4] = {'C', 'P', 'T', 'H'};
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t sampleSize;
+        uint32_t reserved;
+    };
+}
+
+/**
+ * Logs the camera once per frame to a camera path file, for replaying the same fly-through later.
+ * Samples are streamed to the file as they are recorded, so the path survives the app being closed at any point.
+ * The demos record the simulated camera after a frame's steps, stamped with FixedTimestep::simulatedTime, so
+ * each sample's time is the time its pose was simulated at rather than when the frame happened to start.
+ */
+class CameraPathRecorder {
+public:
+    CameraPathRecorder() = default;
+    CameraPathRecorder(const CameraPathRecorder&) = delete;
+    CameraPathRecorder& operator=(const CameraPathRecorder&) = delete;
+
+    ~CameraPathRecorder() {
+        close();
+    }
+
+    // starts a new file at path, false (printing why) if it can't be written
+    bool open(const std::string& path) {
+        close();
+        out_.open(path, std::ios::binary | std::ios::trunc);
+        CameraPathFile::FileHeader header{};
+        std::memcpy(header.magic, CameraPathFile::magic, sizeof(header.magic));
+        header.version = CameraPathFile::version;
+        header.sampleSize = sizeof(CameraPathSample);
+        out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (!out_) {
+            std::cout << "ERROR::CAMERA_PATH::FILE_NOT_SUCCESSFULLY_WRITTEN: " << path << std::endl;
+            out_.close();
+            return false;
+        }
+        path_ = path;
+        sampleCount_ = 0;
+        return true;
+    }
+
+    bool isOpen() const {
+        return out_.is_open();
+    }
+
+    // appends the camera's state at time, in seconds of the clock the camera moves by, the first sample is at 0
+    void record(double time, const Camera& camera) {
+        if (!out_.is_open()) {
+            return;
+        }
+        if (sampleCount_ == 0) {
+            startTime_ = time;
+        }
+        CameraPathSample sample{static_cast<float>(time - startTime_), camera.getPose()};
+        out_.write(reinterpret_cast<const char*>(&sample), sizeof(sample));
+        sampleCount_++;
+    }
+
+    // finishes the file, false (printing why) if any write failed
+    bool close() {
+        if (!out_.is_open()) {
+            return true;
+        }
+        out_.close();
+        if (!out_) {
+            std::cout << "ERROR::CAMERA_PATH::FILE_NOT_SUCCESSFULLY_WRITTEN: " << path_ << std::endl;
+            return false;
+        }
+        std::cout << "recorded " << sampleCount_ << " camera samples to " << path_ << std::endl;
+        return true;
+    }
+
+private:
+    std::ofstream out_;
+    std::string path_;
+    double startTime_ = 0.0;
+    size_t sampleCount_ = 0;
+};
+
+/**
+ * A recorded camera path, sampled at any time by interpolating between the recorded frames.
+ */
+class CameraPath {
+public:
+    // reads a file written by CameraPathRecorder, false (printing why) if it is missing or malformed
+    bool load(const std::string& path) {
+        samples_.clear();
+        MappedFile file;
+        if (!file.open(path)) {
+            std::cout << "ERROR::CAMERA_PATH::FILE_NOT_SUCCESSFULLY_READ: " << path << std::endl;
+            return false;
+        }
+
+        CameraPathFile::FileHeader header{};
+        size_t payload = file.size() >= sizeof(header) ? file.size() - sizeof(header) : 0;
+        if (file.size() >= sizeof(header)) {
+            std::memcpy(&header, file.data(), sizeof(header));
+        }
+        if (std::memcmp(header.magic, CameraPathFile::magic, sizeof(header.magic)) != 0
+            || header.version != CameraPathFile::version
+            || header.sampleSize != sizeof(CameraPathSample)
+            || payload % sizeof(CameraPathSample) != 0
+            || payload == 0) {
+            std::cout << "ERROR::CAMERA_PATH::INVALID_FILE: " << path << std::endl;
+            return false;
+        }
+
+        samples_.resize(payload / sizeof(CameraPathSample));
+        std::memcpy(samples_.data(), file.data() + sizeof(header), payload);
+        for (size_t i = 1; i < samples_.size(); i++) {
+            if (samples_[i].time < samples_[i - 1].time) {
+                std::cout << "ERROR::CAMERA_PATH::INVALID_FILE: " << path << " (time goes backwards)" << std::endl;
+                samples_.clear();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool empty() const {
+        return samples_.empty();
+    }
+
+    size_t size() const {
+        return samples_.size();
+    }
+
+    // time of the last sample, the path starts at 0
+    float duration() const {
+        return samples_.empty() ? 0.0f : samples_.back().time;
+    }
+
+    // puts camera where the path is at time, clamped to the first and last sample
+    void apply(float time, Camera& camera) const {
+        if (samples_.empty()) {
+            return;
+        }
+        auto next = std::upper_bound(samples_.begin(), samples_.end(), time,
+            [](float t, const CameraPathSample& sample) { return t < sample.time; });
+        if (next == samples_.begin() || next == samples_.end()) {
+            camera.setPose(next == samples_.end() ? samples_.back().pose : samples_.front().pose);
+            return;
+        }
+
+        const CameraPathSample& a = *(next - 1);
+        const CameraPathSample& b = *next;
+        float span = b.time - a.time;
+        float t = span > 0.0f ? (time - a.time) / span : 1.0f;
+        camera.setPose(interpolate(a.pose, b.pose, t));
+    }
+
+private:
+    std::vector<CameraPathSample> samples_;
+};
+
+/**
+ * Drives a Camera along a CameraPath at a fixed simulated timestep, one step per frame, so every run renders
+ * exactly the same frames however long each one takes. Meanwhile it measures the real frame times and
+ * reports them when the path ends, for A/B comparisons of the same fly-through.
+ */
+class CameraPathPlayback {
+public:
+    static constexpr float defaultTimestep = 1.0f / 60.0f;
+
+    explicit CameraPathPlayback(CameraPath path, float timestep = defaultTimestep)
+        : path_(std::move(path)), timestep_(timestep) {}
+
+    /**
+     * Moves camera to the next step, false once the path has ended.
+     * Call once per frame, the time since the previous call counts as that frame's time.
+     */
+    bool advance(Camera& camera) {
+        auto now = Clock::now();
+        if (step_ > 0) {
+            frameTimes_.push_back(std::chrono::duration<double, std::milli>(now - lastAdvance_).count());
+        }
+        lastAdvance_ = now;
+
+        float time = step_ * timestep_;
+        if (time > path_.duration()) {
+            return false;
+        }
+        path_.apply(time, camera);
+        step_++;
+        return true;
+    }
+
+    // the simulated time between two frames, use it as the frame's delta time for anything else that animates
+    float timestep() const {
+        return timestep_;
+    }
+
+    void printReport(const std::string& name) const {
+        std::cout << name << " camera path: " << path_.duration() << " s at " << timestep_ * 1000.0f << " ms steps, "
+                  << frameTimes_.size() << " frames timed" << std::endl;
+        if (frameTimes_.empty()) {
+            return;
+        }
+        std::vector<double> sorted = frameTimes_;
+        std::sort(sorted.begin(), sorted.end());
+        double total = 0.0;
+        for (double frameTime : sorted) {
+            total += frameTime;
+        }
+        auto percentile = [&sorted](double p) {
+            return sorted[static_cast<size_t>(p * (sorted.size() - 1) + 0.5)];
+        };
+        std::cout << "  frame time: mean " << total / sorted.size() << " ms, median " << percentile(0.5)
+                  << " ms, 95th " << percentile(0.95) << " ms, 99th " << percentile(0.99)
+                  << " ms, max " << sorted.back() << " ms (" << sorted.size() * 1000.0 / total << " fps)" << std::endl;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    CameraPath path_;
+    float timestep_;
+    size_t step_ = 0;
+    Clock::time_point lastAdvance_;
+    std::vector<double> frameTimes_;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+/**
+ * Fixed timestep for the simulation (camera movement, animated objects), decoupled from the frame rate.
+ *
+ * Each frame adds its real duration to an accumulator and runs as many whole steps as fit, so the simulation
+ * advances by the same amounts however fast or unevenly frames are drawn. The leftover fraction of a step is
+ * alpha, rendering interpolates between the last two simulated states by it (see Interpolated) instead of
+ * showing a state up to a step old. After a stall (a load, a breakpoint) at most maxStepsPerFrame run, the
+ * time beyond that is dropped rather than caught up, which would make the next frame slower still.
+ */
+class FixedTimestep {
+public:
+    static constexpr double defaultStep = 1.0 / 120.0;
+    static constexpr int defaultMaxStepsPerFrame = 8;
+
+    explicit FixedTimestep(double step = defaultStep, int maxStepsPerFrame = defaultMaxStepsPerFrame)
+        : step_(step), maxStepsPerFrame_(maxStepsPerFrame) {}
+
+    // adds a frame's real time in seconds, returns how many steps to simulate this frame
+    int advance(double frameTime) {
+        accumulator_ += std::max(frameTime, 0.0);
+        int steps = static_cast<int>(accumulator_ / step_);
+        if (steps > maxStepsPerFrame_) {
+            droppedSteps_ += steps - maxStepsPerFrame_;
+            steps = maxStepsPerFrame_;
+            // keep the fraction so alpha stays continuous
+            accumulator_ = accumulator_ - static_cast<int>(accumulator_ / step_) * step_;
+        } else {
+            accumulator_ -= steps * step_;
+        }
+        stepCount_ += steps;
+        return steps;
+    }
+
+    // seconds simulated by each step
+    float step() const {
+        return static_cast<float>(step_);
+    }
+
+    // how far rendering is between the previous and the current simulated state, in [0, 1)
+    float alpha() const {
+        return static_cast<float>(accumulator_ / step_);
+    }
+
+    // steps simulated so far, and steps skipped because a frame needed more than maxStepsPerFrame
+    uint64_t stepCount() const {
+        return stepCount_;
+    }
+
+    uint64_t droppedSteps() const {
+        return droppedSteps_;
+    }
+
+    // seconds simulated so far, the time the simulated state is at (dropped steps don't count)
+    double simulatedTime() const {
+        return stepCount_ * step_;
+    }
+
+private:
+    double step_;
+    int maxStepsPerFrame_;
+    double accumulator_ = 0.0;
+    uint64_t stepCount_ = 0;
+    uint64_t droppedSteps_ = 0;
+};
+
+/**
+ * A simulated value and its value one step earlier, rendered at FixedTimestep::alpha between the two.
+ * Call beginStep before each simulation step changes current.
+ */
+template <typename T>
+struct Interpolated {
+    T previous;
+    T current;
+
+    explicit Interpolated(const T& value = T()) : previous(value), current(value) {}
+
+    void beginStep() {
+        previous = current;
+    }
+
+    T at(float alpha) const {
+        return glm::mix(previous, current, alpha);
+    }
+};
@@ -0,0 +1,431 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+// the SIMD kernels are compiled with target attributes and picked at runtime, no -msse/-mavx needed
+#define FRUSTUM_CULLING_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * The six planes bounding what a view-projection matrix can see, in world space (or whatever space the matrix
+ * maps from). Each plane is (normal, distance) with the normal pointing inwards and normalized, so
+ * dot(normal, p) + distance is the signed distance of p from the plane.
+ */
+struct Frustum {
+    enum PlaneIndex { Left, Right, Bottom, Top, Near, Far, PlaneCount };
+
+    glm::vec4 planes[PlaneCount];
+
+    // Gribb/Hartmann plane extraction, for GL clip space (-w <= z <= w)
+    static Frustum fromViewProjection(const glm::mat4& viewProjection) {
+        // glm is column major, row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+        auto row = [&viewProjection](int i) {
+            return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+        };
+        Frustum frustum;
+        frustum.planes[Left] = row(3) + row(0);
+        frustum.planes[Right] = row(3) - row(0);
+        frustum.planes[Bottom] = row(3) + row(1);
+        frustum.planes[Top] = row(3) - row(1);
+        frustum.planes[Near] = row(3) + row(2);
+        frustum.planes[Far] = row(3) - row(2);
+        for (glm::vec4& plane : frustum.planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+        return frustum;
+    }
+
+    /**
+     * False if the sphere is entirely outside one of the planes. Conservative: spheres near a corner
+     * of the frustum may pass without intersecting it.
+     */
+    bool intersectsSphere(const glm::vec3& center, float radius) const {
+        for (const glm::vec4& plane : planes) {
+            if (!(plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w >= -radius)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // same for the box center +- extent, which reaches |normal| . extent towards each plane
+    bool intersectsAabb(const glm::vec3& center, const glm::vec3& extent) const {
+        for (const glm::vec4& plane : planes) {
+            float reach = std::fabs(plane.x) * extent.x + std::fabs(plane.y) * extent.y + std::fabs(plane.z) * extent.z;
+            if (!(plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w >= -reach)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * Bounding spheres in SoA layout, one array per component, so a SIMD kernel loads 4 or 8 objects per register.
+ */
+struct SphereBatch {
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> radius;
+
+    size_t size() const {
+        return radius.size();
+    }
+
+    void clear() {
+        centerX.clear();
+        centerY.clear();
+        centerZ.clear();
+        radius.clear();
+    }
+
+    void reserve(size_t count) {
+        centerX.reserve(count);
+        centerY.reserve(count);
+        centerZ.reserve(count);
+        radius.reserve(count);
+    }
+
+    void add(const glm::vec3& center, float sphereRadius) {
+        centerX.push_back(center.x);
+        centerY.push_back(center.y);
+        centerZ.push_back(center.z);
+        radius.push_back(sphereRadius);
+    }
+};
+
+/**
+ * Axis aligned boxes in SoA layout, stored as center and half extent which is what the plane test needs.
+ */
+struct AabbBatch {
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> extentX;
+    std::vector<float> extentY;
+    std::vector<float> extentZ;
+
+    size_t size() const {
+        return centerX.size();
+    }
+
+    void clear() {
+        for (std::vector<float>* component : {&centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ}) {
+            component->clear();
+        }
+    }
+
+    void reserve(size_t count) {
+        for (std::vector<float>* component : {&centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ}) {
+            component->reserve(count);
+        }
+    }
+
+    void add(const glm::vec3& min, const glm::vec3& max) {
+        glm::vec3 center = (min + max) * 0.5f;
+        glm::vec3 extent = (max - min) * 0.5f;
+        centerX.push_back(center.x);
+        centerY.push_back(center.y);
+        centerZ.push_back(center.z);
+        extentX.push_back(extent.x);
+        extentY.push_back(extent.y);
+        extentZ.push_back(extent.z);
+    }
+};
+
+/**
+ * One bit per object of a batch, set if it is (potentially) visible.
+ */
+class VisibilityMask {
+public:
+    // clears every bit
+    void resize(size_t count) {
+        count_ = count;
+        words_.assign((count + 63) / 64, 0);
+    }
+
+    size_t size() const {
+        return count_;
+    }
+
+    bool visible(size_t index) const {
+        return (words_[index / 64] >> (index % 64)) & 1;
+    }
+
+    void set(size_t index) {
+        words_[index / 64] |= uint64_t(1) << (index % 64);
+    }
+
+    // ors bits into the word holding index, bits[0] is index, which has to be a multiple of 4
+    void setBits(size_t index, uint64_t bits) {
+        words_[index / 64] |= bits << (index % 64);
+    }
+
+    size_t visibleCount() const {
+        size_t count = 0;
+        for (uint64_t word : words_) {
+            for (; word != 0; word &= word - 1) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    const std::vector<uint64_t>& words() const {
+        return words_;
+    }
+
+    bool operator==(const VisibilityMask& other) const {
+        return count_ == other.count_ && words_ == other.words_;
+    }
+
+    bool operator!=(const VisibilityMask& other) const {
+        return !(*this == other);
+    }
+
+private:
+    size_t count_ = 0;
+    std::vector<uint64_t> words_;
+};
+
+/**
+ * Batch frustum tests of SphereBatch/AabbBatch into a VisibilityMask.
+ *
+ * The SSE and AVX kernels test 4 and 8 objects per iteration with the same operations in the same order
+ * as the scalar reference (Frustum::intersectsSphere/intersectsAabb), so all kernels produce identical masks.
+ * They are compiled with target attributes and selected at runtime by CPU support, bestKernel is the
+ * fastest one available. Non x86 builds only have the scalar kernel.
+ */
+namespace FrustumCulling {
+    enum class Kernel {
+        Scalar,
+        Sse,
+        Avx
+    };
+
+    inline const char* kernelName(Kernel kernel) {
+        switch (kernel) {
+            case Kernel::Sse: return "SSE";
+            case Kernel::Avx: return "AVX";
+            default: return "scalar";
+        }
+    }
+
+    inline bool isSupported(Kernel kernel) {
+        switch (kernel) {
+#ifdef FRUSTUM_CULLING_X86
+            case Kernel::Sse: return __builtin_cpu_supports("sse2");
+            case Kernel::Avx: return __builtin_cpu_supports("avx");
+#else
+            case Kernel::Sse: return false;
+            case Kernel::Avx: return false;
+#endif
+            default: return true;
+        }
+    }
+
+    inline Kernel bestKernel() {
+        static const Kernel best = isSupported(Kernel::Avx) ? Kernel::Avx
+            : isSupported(Kernel::Sse) ? Kernel::Sse : Kernel::Scalar;
+        return best;
+    }
+
+    namespace detail {
+        // scalar reference for [first, count)
+        inline void cullSpheresScalar(const Frustum& frustum, const SphereBatch& spheres, size_t first, VisibilityMask& mask) {
+            for (size_t i = first; i < spheres.size(); i++) {
+                glm::vec3 center(spheres.centerX[i], spheres.centerY[i], spheres.centerZ[i]);
+                if (frustum.intersectsSphere(center, spheres.radius[i])) {
+                    mask.set(i);
+                }
+            }
+        }
+
+        inline void cullAabbsScalar(const Frustum& frustum, const AabbBatch& boxes, size_t first, VisibilityMask& mask) {
+            for (size_t i = first; i < boxes.size(); i++) {
+                glm::vec3 center(boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]);
+                glm::vec3 extent(boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i]);
+                if (frustum.intersectsAabb(center, extent)) {
+                    mask.set(i);
+                }
+            }
+        }
+
+#ifdef FRUSTUM_CULLING_X86
+        // returns the first object left for the scalar kernel
+        __attribute__((target("sse2")))
+        inline size_t cullSpheresSse(const Frustum& frustum, const SphereBatch& spheres, VisibilityMask& mask) {
+            __m128 planeX[Frustum::PlaneCount], planeY[Frustum::PlaneCount], planeZ[Frustum::PlaneCount], planeW[Frustum::PlaneCount];
+            for (int p = 0; p < Frustum::PlaneCount; p++) {
+                planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+                planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+                planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+                planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+            }
+            const __m128 signBit = _mm_set1_ps(-0.0f);
+
+            size_t count = spheres.size() & ~size_t(3);
+            for (size_t i = 0; i < count; i += 4) {
+                __m128 x = _mm_loadu_ps(&spheres.centerX[i]);
+                __m128 y = _mm_loadu_ps(&spheres.centerY[i]);
+                __m128 z = _mm_loadu_ps(&spheres.centerZ[i]);
+                __m128 negativeRadius = _mm_xor_ps(_mm_loadu_ps(&spheres.radius[i]), signBit);
+                __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for (int p = 0; p < Frustum::PlaneCount; p++) {
+                    __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+                        _mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y)), _mm_mul_ps(planeZ[p], z)), planeW[p]);
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+                }
+                mask.setBits(i, static_cast<uint64_t>(_mm_movemask_ps(inside)));
+            }
+            return count;
+        }
+
+        __attribute__((target("sse2")))
+        inline size_t cullAabbsSse(const Frustum& frustum, const AabbBatch& boxes, VisibilityMask& mask) {
+            __m128 planeX[Frustum::PlaneCount], planeY[Frustum::PlaneCount], planeZ[Frustum::PlaneCount], planeW[Frustum::PlaneCount];
+            __m128 absX[Frustum::PlaneCount], absY[Frustum::PlaneCount], absZ[Frustum::PlaneCount];
+            for (int p = 0; p < Frustum::PlaneCount; p++) {
+                planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+                planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+                planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+                planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+                absX[p] = _mm_set1_ps(std::fabs(frustum.planes[p].x));
+                absY[p] = _mm_set1_ps(std::fabs(frustum.planes[p].y));
+                absZ[p] = _mm_set1_ps(std::fabs(frustum.planes[p].z));
+            }
+            const __m128 signBit = _mm_set1_ps(-0.0f);
+
+            size_t count = boxes.size() & ~size_t(3);
+            for (size_t i = 0; i < count; i += 4) {
+                __m128 x = _mm_loadu_ps(&boxes.centerX[i]);
+                __m128 y = _mm_loadu_ps(&boxes.centerY[i]);
+                __m128 z = _mm_loadu_ps(&boxes.centerZ[i]);
+                __m128 extentX = _mm_loadu_ps(&boxes.extentX[i]);
+                __m128 extentY = _mm_loadu_ps(&boxes.extentY[i]);
+                __m128 extentZ = _mm_loadu_ps(&boxes.extentZ[i]);
+                __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for (int p = 0; p < Frustum::PlaneCount; p++) {
+                    __m128 reach = _mm_add_ps(_mm_add_ps(
+                        _mm_mul_ps(absX[p], extentX), _mm_mul_ps(absY[p], extentY)), _mm_mul_ps(absZ[p], extentZ));
+                    __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+                        _mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y)), _mm_mul_ps(planeZ[p], z)), planeW[p]);
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_xor_ps(reach, signBit)));
+                }
+                mask.setBits(i, static_cast<uint64_t>(_mm_movemask_ps(inside)));
+            }
+            return count;
+        }
+
+        __attribute__((target("avx")))
+        inline size_t cullSpheresAvx(const Frustum& frustum, const SphereBatch& spheres, VisibilityMask& mask) {
+            __m256 planeX[Frustum::PlaneCount], planeY[Frustum::PlaneCount], planeZ[Frustum::PlaneCount], planeW[Frustum::PlaneCount];
+            for (int p = 0; p < Frustum::PlaneCount; p++) {
+                planeX[p] = _mm256_set1_ps(frustum.planes[p].x);
+                planeY[p] = _mm256_set1_ps(frustum.planes[p].y);
+                planeZ[p] = _mm256_set1_ps(frustum.planes[p].z);
+                planeW[p] = _mm256_set1_ps(frustum.planes[p].w);
+            }
+            const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+            size_t count = spheres.size() & ~size_t(7);
+            for (size_t i = 0; i < count; i += 8) {
+                __m256 x = _mm256_loadu_ps(&spheres.centerX[i]);
+                __m256 y = _mm256_loadu_ps(&spheres.centerY[i]);
+                __m256 z = _mm256_loadu_ps(&spheres.centerZ[i]);
+                __m256 negativeRadius = _mm256_xor_ps(_mm256_loadu_ps(&spheres.radius[i]), signBit);
+                __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+                for (int p = 0; p < Frustum::PlaneCount; p++) {
+                    __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+                        _mm256_mul_ps(planeX[p], x), _mm256_mul_ps(planeY[p], y)), _mm256_mul_ps(planeZ[p], z)), planeW[p]);
+                    inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+                }
+                mask.setBits(i, static_cast<uint64_t>(_mm256_movemask_ps(inside)));
+            }
+            return count;
+        }
+
+        __attribute__((target("avx")))
+        inline size_t cullAabbsAvx(const Frustum& frustum, const AabbBatch& boxes, VisibilityMask& mask) {
+            __m256 planeX[Frustum::PlaneCount], planeY[Frustum::PlaneCount], planeZ[Frustum::PlaneCount], planeW[Frustum::PlaneCount];
+            __m256 absX[Frustum::PlaneCount], absY[Frustum::PlaneCount], absZ[Frustum::PlaneCount];
+            for (int p = 0; p < Frustum::PlaneCount; p++) {
+                planeX[p] = _mm256_set1_ps(frustum.planes[p].x);
+                planeY[p] = _mm256_set1_ps(frustum.planes[p].y);
+                planeZ[p] = _mm256_set1_ps(frustum.planes[p].z);
+                planeW[p] = _mm256_set1_ps(frustum.planes[p].w);
+                absX[p] = _mm256_set1_ps(std::fabs(frustum.planes[p].x));
+                absY[p] = _mm256_set1_ps(std::fabs(frustum.planes[p].y));
+                absZ[p] = _mm256_set1_ps(std::fabs(frustum.planes[p].z));
+            }
+            const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+            size_t count = boxes.size() & ~size_t(7);
+            for (size_t i = 0; i < count; i += 8) {
+                __m256 x = _mm256_loadu_ps(&boxes.centerX[i]);
+                __m256 y = _mm256_loadu_ps(&boxes.centerY[i]);
+                __m256 z = _mm256_loadu_ps(&boxes.centerZ[i]);
+                __m256 extentX = _mm256_loadu_ps(&boxes.extentX[i]);
+                __m256 extentY = _mm256_loadu_ps(&boxes.extentY[i]);
+                __m256 extentZ = _mm256_loadu_ps(&boxes.extentZ[i]);
+                __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+                for (int p = 0; p < Frustum::PlaneCount; p++) {
+                    __m256 reach = _mm256_add_ps(_mm256_add_ps(
+                        _mm256_mul_ps(absX[p], extentX), _mm256_mul_ps(absY[p], extentY)), _mm256_mul_ps(absZ[p], extentZ));
+                    __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+                        _mm256_mul_ps(planeX[p], x), _mm256_mul_ps(planeY[p], y)), _mm256_mul_ps(planeZ[p], z)), planeW[p]);
+                    inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_xor_ps(reach, signBit), _CMP_GE_OQ));
+                }
+                mask.setBits(i, static_cast<uint64_t>(_mm256_movemask_ps(inside)));
+            }
+            return count;
+        }
+#endif
+    }
+
+    /**
+     * Sets bit i of mask if sphere i intersects the frustum, see Frustum::intersectsSphere.
+     * @precondition kernel is supported
+     */
+    inline void cullSpheres(const Frustum& frustum, const SphereBatch& spheres, VisibilityMask& mask, Kernel kernel = bestKernel()) {
+        mask.resize(spheres.size());
+        size_t first = 0;
+#ifdef FRUSTUM_CULLING_X86
+        if (kernel == Kernel::Avx) {
+            first = detail::cullSpheresAvx(frustum, spheres, mask);
+        } else if (kernel == Kernel::Sse) {
+            first = detail::cullSpheresSse(frustum, spheres, mask);
+        }
+#else
+        (void) kernel;
+#endif
+        detail::cullSpheresScalar(frustum, spheres, first, mask);
+    }
+
+    /**
+     * Sets bit i of mask if box i intersects the frustum, see Frustum::intersectsAabb.
+     * @precondition kernel is supported
+     */
+    inline void cullAabbs(const Frustum& frustum, const AabbBatch& boxes, VisibilityMask& mask, Kernel kernel = bestKernel()) {
+        mask.resize(boxes.size());
+        size_t first = 0;
+#ifdef FRUSTUM_CULLING_X86
+        if (kernel == Kernel::Avx) {
+            first = detail::cullAabbsAvx(frustum, boxes, mask);
+        } else if (kernel == Kernel::Sse) {
+            first = detail::cullAabbsSse(frustum, boxes, mask);
+        }
+#else
+        (void) kernel;
+#endif
+        detail::cullAabbsScalar(frustum, boxes, first, mask);
+    }
+}
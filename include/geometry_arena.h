@@ -0,0 +1,287 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "gl_resource.h"
+#include "range_allocator.h"
+#include "vertex_layout.h"
+
+/**
+ * Where a mesh lives inside its arena, in the arguments glDrawElementsBaseVertex takes.
+ */
+struct GeometryRange {
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    int32_t baseVertex = 0;
+};
+
+/**
+ * Shared GPU storage for every mesh of one vertex type.
+ *
+ * Vertices and indices are sub-allocated from one large VBO and EBO, which a single VAO is set up for,
+ * so drawing many meshes needs no VAO or buffer switches. Indices stay mesh local and are offset with
+ * glDrawElementsBaseVertex. Ranges are handed out as Allocation handles because they move: when a
+ * request doesn't fit, the arena is compacted (and grown if needed) into fresh buffers with glCopyBufferSubData.
+ * Context thread only.
+ */
+template <typename VertexT>
+class GeometryArena {
+public:
+    using Allocation = uint32_t;
+    static constexpr Allocation invalidAllocation = UINT32_MAX;
+
+    static constexpr uint32_t initialVertexCapacity = 1u << 16;
+    static constexpr uint32_t initialIndexCapacity = 1u << 18;
+
+    /**
+     * The arena meshes of this vertex type live in. It is never destroyed,
+     * its GL objects go away with the context instead of being deleted after it during static destruction.
+     */
+    static GeometryArena& shared() {
+        static GeometryArena* arena = new GeometryArena();
+        return *arena;
+    }
+
+    GeometryArena() = default;
+
+    GeometryArena(const GeometryArena&) = delete;
+    GeometryArena& operator=(const GeometryArena&) = delete;
+
+    /**
+     * Copies the mesh into the arena. Returns invalidAllocation for an empty mesh.
+     */
+    Allocation allocate(const VertexT* vertices, uint32_t vertexCount, const unsigned int* indices, uint32_t indexCount) {
+        if (vertexCount == 0 || indexCount == 0) {
+            return invalidAllocation;
+        }
+
+        uint32_t vertexOffset, indexOffset;
+        if (!reserve(vertexCount, indexCount, vertexOffset, indexOffset)) {
+            relocate(vertexCount, indexCount);
+            reserve(vertexCount, indexCount, vertexOffset, indexOffset);
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer_.get());
+        glBufferSubData(GL_ARRAY_BUFFER, GLintptr(vertexOffset) * sizeof(VertexT), GLsizeiptr(vertexCount) * sizeof(VertexT), vertices);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // the copy target keeps the element buffer binding of whatever VAO is bound untouched
+        glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer_.get());
+        glBufferSubData(GL_COPY_WRITE_BUFFER, GLintptr(indexOffset) * sizeof(unsigned int), GLsizeiptr(indexCount) * sizeof(unsigned int), indices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        Allocation allocation = static_cast<Allocation>(slots_.size());
+        if (freeSlots_.empty()) {
+            slots_.emplace_back();
+        } else {
+            allocation = freeSlots_.back();
+            freeSlots_.pop_back();
+        }
+        slots_[allocation] = {vertexOffset, vertexCount, indexOffset, indexCount, true};
+        return allocation;
+    }
+
+    void free(Allocation allocation) {
+        if (allocation >= slots_.size() || !slots_[allocation].live) {
+            return;
+        }
+
+        Slot& slot = slots_[allocation];
+        vertexAllocator_.free(slot.vertexOffset);
+        indexAllocator_.free(slot.indexOffset);
+        slot = Slot();
+        freeSlots_.push_back(allocation);
+    }
+
+    GeometryRange range(Allocation allocation) const {
+        if (allocation >= slots_.size() || !slots_[allocation].live) {
+            return GeometryRange();
+        }
+
+        const Slot& slot = slots_[allocation];
+        return {slot.indexOffset, slot.indexCount, static_cast<int32_t>(slot.vertexOffset)};
+    }
+
+    void bind() const {
+        glBindVertexArray(vertexArray_.get());
+    }
+
+    /**
+     * Binds the arena VAO and draws the allocation, the VAO is left bound for the next draw.
+     */
+    void draw(Allocation allocation) const {
+        draw(allocation, 0, range(allocation).indexCount);
+    }
+
+    /**
+     * Draws indexCount indices starting firstIndex indices into the allocation (e.g. one level of detail).
+     */
+    void draw(Allocation allocation, uint32_t firstIndex, uint32_t indexCount) const {
+        GeometryRange geometry = range(allocation);
+        if (indexCount == 0 || firstIndex + indexCount > geometry.indexCount) {
+            return;
+        }
+
+        bind();
+        glDrawElementsBaseVertex(
+            GL_TRIANGLES, indexCount, GL_UNSIGNED_INT,
+            reinterpret_cast<const void*>(size_t(geometry.firstIndex + firstIndex) * sizeof(unsigned int)),
+            geometry.baseVertex
+        );
+    }
+
+    /**
+     * Closes every gap between allocations, the buffers keep their size.
+     */
+    void defragment() {
+        if (vertexAllocator_.allocationCount() > 0) {
+            relocate(0, 0);
+        }
+    }
+
+    // occupancy and fragmentation, in vertices and indices
+    const RangeAllocator& vertexAllocator() const {
+        return vertexAllocator_;
+    }
+
+    const RangeAllocator& indexAllocator() const {
+        return indexAllocator_;
+    }
+
+    // number of times the buffers were compacted or grown
+    unsigned int relocationCount() const {
+        return relocations_;
+    }
+
+private:
+    struct Slot {
+        uint32_t vertexOffset = 0;
+        uint32_t vertexCount = 0;
+        uint32_t indexOffset = 0;
+        uint32_t indexCount = 0;
+        bool live = false;
+    };
+
+    GLVertexArray vertexArray_;
+    GLBuffer vertexBuffer_;
+    GLBuffer indexBuffer_;
+
+    RangeAllocator vertexAllocator_;
+    RangeAllocator indexAllocator_;
+    std::vector<Slot> slots_;
+    std::vector<Allocation> freeSlots_;
+    unsigned int relocations_ = 0;
+
+    /**
+     * Allocates both ranges, returns false (allocating nothing) if either doesn't fit.
+     */
+    bool reserve(uint32_t vertexCount, uint32_t indexCount, uint32_t& vertexOffset, uint32_t& indexOffset) {
+        if (!vertexAllocator_.allocate(vertexCount, vertexOffset)) {
+            return false;
+        }
+        if (!indexAllocator_.allocate(indexCount, indexOffset)) {
+            vertexAllocator_.free(vertexOffset);
+            return false;
+        }
+        return true;
+    }
+
+    static uint32_t grownCapacity(const RangeAllocator& allocator, uint32_t request, uint32_t initialCapacity) {
+        if (allocator.freeSize() >= request) {
+            // fits once compacted
+            return allocator.capacity();
+        }
+        uint32_t required = allocator.usedSize() + request;
+        return std::max({required, allocator.capacity() * 2, initialCapacity});
+    }
+
+    /**
+     * Compacts both allocators and moves the live ranges into new buffers,
+     * grown if needed so that vertexRequest/indexRequest more units fit.
+     */
+    void relocate(uint32_t vertexRequest, uint32_t indexRequest) {
+        relocations_++;
+
+        std::unordered_map<uint32_t, uint32_t> vertexMoves;
+        for (const RangeMove& move : vertexAllocator_.compact()) {
+            vertexMoves[move.from] = move.to;
+        }
+        std::unordered_map<uint32_t, uint32_t> indexMoves;
+        for (const RangeMove& move : indexAllocator_.compact()) {
+            indexMoves[move.from] = move.to;
+        }
+
+        vertexAllocator_.grow(grownCapacity(vertexAllocator_, vertexRequest, initialVertexCapacity));
+        indexAllocator_.grow(grownCapacity(indexAllocator_, indexRequest, initialIndexCapacity));
+
+        GLBuffer newVertexBuffer = GLBuffer::create();
+        GLBuffer newIndexBuffer = GLBuffer::create();
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newVertexBuffer.get());
+        glBufferData(GL_COPY_WRITE_BUFFER, GLsizeiptr(vertexAllocator_.capacity()) * sizeof(VertexT), nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newIndexBuffer.get());
+        glBufferData(GL_COPY_WRITE_BUFFER, GLsizeiptr(indexAllocator_.capacity()) * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+
+        // copying into fresh buffers sidesteps overlapping source and destination ranges
+        for (Slot& slot : slots_) {
+            if (!slot.live) {
+                continue;
+            }
+
+            uint32_t vertexOffset = movedOffset(vertexMoves, slot.vertexOffset);
+            uint32_t indexOffset = movedOffset(indexMoves, slot.indexOffset);
+
+            glBindBuffer(GL_COPY_READ_BUFFER, vertexBuffer_.get());
+            glBindBuffer(GL_COPY_WRITE_BUFFER, newVertexBuffer.get());
+            glCopyBufferSubData(
+                GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                GLintptr(slot.vertexOffset) * sizeof(VertexT), GLintptr(vertexOffset) * sizeof(VertexT),
+                GLsizeiptr(slot.vertexCount) * sizeof(VertexT)
+            );
+
+            glBindBuffer(GL_COPY_READ_BUFFER, indexBuffer_.get());
+            glBindBuffer(GL_COPY_WRITE_BUFFER, newIndexBuffer.get());
+            glCopyBufferSubData(
+                GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                GLintptr(slot.indexOffset) * sizeof(unsigned int), GLintptr(indexOffset) * sizeof(unsigned int),
+                GLsizeiptr(slot.indexCount) * sizeof(unsigned int)
+            );
+
+            slot.vertexOffset = vertexOffset;
+            slot.indexOffset = indexOffset;
+        }
+
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        // deletes the old buffers
+        vertexBuffer_ = std::move(newVertexBuffer);
+        indexBuffer_ = std::move(newIndexBuffer);
+
+        setupVertexArray();
+    }
+
+    static uint32_t movedOffset(const std::unordered_map<uint32_t, uint32_t>& moves, uint32_t offset) {
+        auto move = moves.find(offset);
+        return move == moves.end() ? offset : move->second;
+    }
+
+    void setupVertexArray() {
+        if (!vertexArray_) {
+            vertexArray_ = GLVertexArray::create();
+        }
+
+        glBindVertexArray(vertexArray_.get());
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer_.get());
+        setupVertexAttributes<VertexT>();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer_.get());
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+};
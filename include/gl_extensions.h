@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include <glad/glad.h>
+
+// the bundled glad loader only covers the OpenGL 3.3 core profile
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void (APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride);
+typedef void (APIENTRYP GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+
+/**
+ * One entry of a GL_DRAW_INDIRECT_BUFFER, laid out as glMultiDrawElementsIndirect reads it.
+ */
+struct DrawElementsIndirectCommand {
+    uint32_t count;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t baseVertex;
+    uint32_t baseInstance;
+};
+
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "indirect commands must be tightly packed");
+
+/**
+ * Entry points and features above OpenGL 3.3, resolved at runtime.
+ * load must be called once on the context thread after gladLoadGLLoader, everything reports unsupported before that.
+ */
+namespace GLExtensions {
+
+    struct Features {
+        // glMultiDrawElementsIndirect and shader storage buffers (GL 4.3)
+        bool multiDrawIndirect = false;
+        // gl_DrawIDARB in vertex shaders
+        bool shaderDrawParameters = false;
+        MultiDrawElementsIndirectProc multiDrawElementsIndirect = nullptr;
+        // glGetProgramBinary/glProgramBinary with at least one binary format (GL 4.1 or ARB_get_program_binary)
+        bool programBinary = false;
+        GetProgramBinaryProc getProgramBinary = nullptr;
+        ProgramBinaryProc programBinaryLoad = nullptr;
+        ProgramParameteriProc programParameteri = nullptr;
+        // shaders compile and link on driver threads, GL_COMPLETION_STATUS_KHR polls them without blocking
+        // (KHR_parallel_shader_compile or ARB_parallel_shader_compile)
+        bool parallelShaderCompile = false;
+        MaxShaderCompilerThreadsProc maxShaderCompilerThreads = nullptr;
+    };
+
+    inline Features& features() {
+        static Features state;
+        return state;
+    }
+
+    inline bool hasExtension(const char* name) {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++) {
+            const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (extension && std::strcmp(extension, name) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline void load(GLADloadproc loadProc) {
+        Features& state = features();
+
+        GLint major = 0;
+        GLint minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        bool gl43 = major > 4 || (major == 4 && minor >= 3);
+
+        if (gl43) {
+            state.multiDrawElementsIndirect =
+                reinterpret_cast<MultiDrawElementsIndirectProc>(loadProc("glMultiDrawElementsIndirect"));
+        }
+        state.multiDrawIndirect = state.multiDrawElementsIndirect != nullptr;
+        state.shaderDrawParameters = gl43 && hasExtension("GL_ARB_shader_draw_parameters");
+
+        bool gl41 = major > 4 || (major == 4 && minor >= 1);
+        if (gl41 || hasExtension("GL_ARB_get_program_binary")) {
+            state.getProgramBinary = reinterpret_cast<GetProgramBinaryProc>(loadProc("glGetProgramBinary"));
+            state.programBinaryLoad = reinterpret_cast<ProgramBinaryProc>(loadProc("glProgramBinary"));
+            state.programParameteri = reinterpret_cast<ProgramParameteriProc>(loadProc("glProgramParameteri"));
+        }
+        // drivers may expose the entry points without supporting any binary format
+        GLint binaryFormats = 0;
+        if (state.getProgramBinary && state.programBinaryLoad && state.programParameteri) {
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+        }
+        state.programBinary = binaryFormats > 0;
+
+        // both extensions share GL_COMPLETION_STATUS_KHR
+        if (hasExtension("GL_KHR_parallel_shader_compile")) {
+            state.maxShaderCompilerThreads =
+                reinterpret_cast<MaxShaderCompilerThreadsProc>(loadProc("glMaxShaderCompilerThreadsKHR"));
+        } else if (hasExtension("GL_ARB_parallel_shader_compile")) {
+            state.maxShaderCompilerThreads =
+                reinterpret_cast<MaxShaderCompilerThreadsProc>(loadProc("glMaxShaderCompilerThreadsARB"));
+        }
+        state.parallelShaderCompile = state.maxShaderCompilerThreads != nullptr;
+        if (state.parallelShaderCompile) {
+            // as many threads as the driver wants to use
+            state.maxShaderCompilerThreads(0xFFFFFFFFu);
+        }
+    }
+
+    // everything the indirect_vertex.glsl draw path needs
+    inline bool supportsIndirectDraw() {
+        return features().multiDrawIndirect && features().shaderDrawParameters;
+    }
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <glad/glad.h>
+
+/**
+ * Move-only owner of a single GL object name, deleted through Traits::destroy when the owner goes away.
+ * Traits provides static GLuint create() and static void destroy(GLuint).
+ * Like every GL call, construction and destruction must happen on the context thread while the context is alive.
+ */
+template <typename Traits>
+class GLResource {
+public:
+    GLResource() = default;
+
+    explicit GLResource(GLuint id) : id_(id) {}
+
+    ~GLResource() {
+        reset();
+    }
+
+    GLResource(const GLResource&) = delete;
+    GLResource& operator=(const GLResource&) = delete;
+
+    GLResource(GLResource&& other) noexcept : id_(other.release()) {}
+
+    GLResource& operator=(GLResource&& other) noexcept {
+        if (this != &other) {
+            reset(other.release());
+        }
+        return *this;
+    }
+
+    static GLResource create() {
+        return GLResource(Traits::create());
+    }
+
+    GLuint get() const {
+        return id_;
+    }
+
+    explicit operator bool() const {
+        return id_ != 0;
+    }
+
+    // gives up ownership without deleting the object
+    GLuint release() {
+        GLuint id = id_;
+        id_ = 0;
+        return id;
+    }
+
+    void reset(GLuint id = 0) {
+        if (id_ != 0) {
+            Traits::destroy(id_);
+        }
+        id_ = id;
+    }
+
+private:
+    GLuint id_ = 0;
+};
+
+struct GLBufferTraits {
+    static GLuint create() {
+        GLuint id;
+        glGenBuffers(1, &id);
+        return id;
+    }
+
+    static void destroy(GLuint id) {
+        glDeleteBuffers(1, &id);
+    }
+};
+
+struct GLVertexArrayTraits {
+    static GLuint create() {
+        GLuint id;
+        glGenVertexArrays(1, &id);
+        return id;
+    }
+
+    static void destroy(GLuint id) {
+        glDeleteVertexArrays(1, &id);
+    }
+};
+
+using GLBuffer = GLResource<GLBufferTraits>;
+using GLVertexArray = GLResource<GLVertexArrayTraits>;
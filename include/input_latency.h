@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Measures how long input waits before a frame showing it is swapped.
+ *
+ * The input callbacks call stampInput as events arrive, the render loop calls frameSwapped right after
+ * glfwSwapBuffers. Each frame the time from the oldest and from the newest input it picked up to its swap is
+ * recorded, and a summary of the frames with input is printed every reportInterval. Events are stamped when
+ * GLFW delivers them and the frame ends when the swap returns, so the OS input queue before and the display's
+ * queueing and scanout after aren't included: compare runs with it, it isn't the full input to photon time.
+ * Context thread only.
+ */
+class InputLatencyTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit InputLatencyTracker(std::chrono::milliseconds reportInterval = std::chrono::milliseconds(2000))
+        : reportInterval_(reportInterval) {}
+
+    // an input event arrived, the next frame to swap shows it
+    void stampInput() {
+        Clock::time_point now = Clock::now();
+        if (!pending_) {
+            oldestInput_ = now;
+            pending_ = true;
+        }
+        newestInput_ = now;
+    }
+
+    // the frame has been swapped, records the latency of the input it showed
+    void frameSwapped() {
+        Clock::time_point now = Clock::now();
+        frames_++;
+        if (pending_) {
+            oldest_.push_back(milliseconds(now - oldestInput_));
+            newest_.push_back(milliseconds(now - newestInput_));
+            pending_ = false;
+        }
+
+        if (lastReport_ == Clock::time_point()) {
+            lastReport_ = now;
+        } else if (now - lastReport_ >= reportInterval_) {
+            report();
+            lastReport_ = now;
+        }
+    }
+
+private:
+    std::chrono::milliseconds reportInterval_;
+    bool pending_ = false;
+    Clock::time_point oldestInput_;
+    Clock::time_point newestInput_;
+    Clock::time_point lastReport_;
+    size_t frames_ = 0;
+    // per frame with input, since the last report
+    std::vector<double> oldest_;
+    std::vector<double> newest_;
+
+    static double milliseconds(Clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    void report() {
+        std::cout << "input to swap latency: " << oldest_.size() << " of " << frames_ << " frames had input";
+        if (!oldest_.empty()) {
+            std::cout << ", oldest event " << summary(oldest_) << ", newest event " << summary(newest_);
+        }
+        std::cout << std::endl;
+        oldest_.clear();
+        newest_.clear();
+        frames_ = 0;
+    }
+
+    static std::string summary(std::vector<double>& latencies) {
+        std::sort(latencies.begin(), latencies.end());
+        double total = 0.0;
+        for (double latency : latencies) {
+            total += latency;
+        }
+        double p95 = latencies[static_cast<size_t>(0.95 * (latencies.size() - 1) + 0.5)];
+        return "mean " + std::to_string(total / latencies.size()) + " ms, 95th " + std::to_string(p95)
+               + " ms, max " + std::to_string(latencies.back()) + " ms";
+    }
+};
@@ -0,0 +1,322 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "geometry_arena.h"
+#include "shader.h"
+#include "texture_registry.h"
+#include "vertex_layout.h"
+#include "vertex_quantization.h"
+
+struct Vertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoords;
+};
+
+template <>
+struct VertexLayout<Vertex> {
+    static constexpr std::array<VertexAttribute, 3> attributes = {{
+        {0, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, position)},
+        {1, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, normal)},
+        {2, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, texCoords)}
+    }};
+};
+
+/**
+ * Layout of the vertex buffer on the GPU, the CPU side copy is always a full Vertex.
+ */
+enum class VertexFormat {
+    // Vertex, 32 bytes of floats
+    Float32,
+    // QuantizedVertex, 16 bytes, needs quantized_vertex.glsl
+    Quantized16
+};
+
+/**
+ * One level of detail of a mesh: a range of its index buffer over the shared vertices.
+ */
+struct MeshLod {
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    // simplification error in model space units, 0 for the full resolution level
+    float error = 0.0f;
+};
+
+/**
+ * CPU side geometry of a mesh, before any GL objects are created for it.
+ */
+struct MeshData {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    // levels of detail stored back to back in indices, finest first. Empty means indices is a single level
+    std::vector<MeshLod> lods;
+};
+
+struct Texture {
+    TextureHandle handle;
+    std::string type;
+    std::string path;
+};
+
+/**
+ * Owns a mesh's vertex and index ranges in the geometry arena of its vertex format, returned to the arena on destruction.
+ * Move-only, so a range is never freed twice or by a stale copy.
+ */
+class MeshGeometry {
+public:
+    MeshGeometry() = default;
+
+    MeshGeometry(VertexFormat format, uint32_t allocation) : format_(format), allocation_(allocation) {}
+
+    ~MeshGeometry() {
+        reset();
+    }
+
+    MeshGeometry(const MeshGeometry&) = delete;
+    MeshGeometry& operator=(const MeshGeometry&) = delete;
+
+    MeshGeometry(MeshGeometry&& other) noexcept
+        : format_(other.format_), allocation_(other.allocation_) {
+        other.allocation_ = GeometryArena<Vertex>::invalidAllocation;
+    }
+
+    MeshGeometry& operator=(MeshGeometry&& other) noexcept {
+        if (this != &other) {
+            reset();
+            format_ = other.format_;
+            allocation_ = other.allocation_;
+            other.allocation_ = GeometryArena<Vertex>::invalidAllocation;
+        }
+        return *this;
+    }
+
+    // current location in the arena, only valid until the arena relocates
+    GeometryRange range() const {
+        if (format_ == VertexFormat::Quantized16) {
+            return GeometryArena<QuantizedVertex>::shared().range(allocation_);
+        }
+        return GeometryArena<Vertex>::shared().range(allocation_);
+    }
+
+    void draw(uint32_t firstIndex, uint32_t indexCount) const {
+        if (format_ == VertexFormat::Quantized16) {
+            GeometryArena<QuantizedVertex>::shared().draw(allocation_, firstIndex, indexCount);
+        } else {
+            GeometryArena<Vertex>::shared().draw(allocation_, firstIndex, indexCount);
+        }
+    }
+
+    void reset() {
+        if (allocation_ == GeometryArena<Vertex>::invalidAllocation) {
+            return;
+        }
+        if (format_ == VertexFormat::Quantized16) {
+            GeometryArena<QuantizedVertex>::shared().free(allocation_);
+        } else {
+            GeometryArena<Vertex>::shared().free(allocation_);
+        }
+        allocation_ = GeometryArena<Vertex>::invalidAllocation;
+    }
+
+private:
+    VertexFormat format_ = VertexFormat::Float32;
+    uint32_t allocation_ = GeometryArena<Vertex>::invalidAllocation;
+};
+
+/**
+ * Move-only: the GPU geometry is owned through MeshGeometry and textures through their shared handles.
+ */
+class Mesh {
+public:
+    // mesh data, empty after releaseCpuData
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    std::vector<Texture> textures;
+    // finest first, always holds at least the full resolution level
+    std::vector<MeshLod> lods;
+
+    Mesh(
+        std::vector<Vertex> vertices,
+        std::vector<unsigned int> indices,
+        std::vector<Texture> textures,
+        VertexFormat format = VertexFormat::Float32,
+        std::vector<MeshLod> lods = std::vector<MeshLod>()
+    )
+        : vertices(std::move(vertices)),
+          indices(std::move(indices)),
+          textures(std::move(textures)),
+          lods(std::move(lods)),
+          format(format)
+    {
+        setupMesh(this->vertices.data(), this->vertices.size(), this->indices.data(), this->indices.size());
+    }
+
+    /**
+     * Builds the mesh from externally owned vertex/index arrays (e.g. a mapped mesh cache).
+     * The GPU buffers are filled directly from the given arrays, which are only copied into
+     * vertices/indices if keepCpuData is set.
+     */
+    Mesh(
+        const Vertex* vertexData, size_t vertexCount,
+        const unsigned int* indexData, size_t indexCount,
+        std::vector<Texture> textures,
+        VertexFormat format = VertexFormat::Float32,
+        std::vector<MeshLod> lods = std::vector<MeshLod>(),
+        bool keepCpuData = true
+    )
+        : textures(std::move(textures)),
+          lods(std::move(lods)),
+          format(format)
+    {
+        if (keepCpuData) {
+            vertices.assign(vertexData, vertexData + vertexCount);
+            indices.assign(indexData, indexData + indexCount);
+        }
+        setupMesh(vertexData, vertexCount, indexData, indexCount);
+    }
+
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+
+    Mesh(Mesh&&) noexcept = default;
+    Mesh& operator=(Mesh&&) noexcept = default;
+
+    // leaves the arena VAO bound, so consecutive meshes of the same format don't rebind
+    void draw(const Shader& shader) {
+        for (unsigned int i = 0; i < textures.size(); i++) {
+            glActiveTexture(GL_TEXTURE0 + i);
+            shader.setInt(samplerIds[i], i);
+            glBindTexture(GL_TEXTURE_2D, textures[i].handle->id);
+        }
+
+        glActiveTexture(GL_TEXTURE0);
+
+        if (format == VertexFormat::Quantized16) {
+            shader.setVec3("positionOffset"_u, positionBounds.offset);
+            shader.setVec3("positionScale"_u, positionBounds.scale);
+        }
+        geometry.draw(currentLod().firstIndex, currentLod().indexCount);
+    }
+
+    /**
+     * Frees the CPU copies of vertices and indices, the GPU geometry, bounds and counts stay.
+     * Only needed to rebuild or re-export the mesh, so the renderer can drop them once uploaded.
+     */
+    void releaseCpuData() {
+        std::vector<Vertex>().swap(vertices);
+        std::vector<unsigned int>().swap(indices);
+    }
+
+    /**
+     * Picks the level drawn from now on. pixelsPerUnit is the size of one model space unit on screen at the mesh.
+     * The coarsest level whose error stays within maxPixelError is used, but a coarser level is only switched to
+     * once its error is below maxPixelError * (1 - hysteresis), so a mesh near a threshold doesn't flicker between levels.
+     */
+    void selectLod(float pixelsPerUnit, float maxPixelError, float hysteresis) {
+        // refine while the current level is visibly too coarse
+        while (lodLevel > 0 && lods[lodLevel].error * pixelsPerUnit > maxPixelError) {
+            lodLevel--;
+        }
+        // coarsen while the next level is comfortably below the threshold
+        while (lodLevel + 1 < lods.size() && lods[lodLevel + 1].error * pixelsPerUnit <= maxPixelError * (1.0f - hysteresis)) {
+            lodLevel++;
+        }
+    }
+
+    // pins the level, clamped to the coarsest one. selectLod moves on from it
+    void setLodLevel(unsigned int level) {
+        lodLevel = std::min<unsigned int>(level, static_cast<unsigned int>(lods.size() - 1));
+    }
+
+    unsigned int getLodLevel() const {
+        return lodLevel;
+    }
+
+    const MeshLod& currentLod() const {
+        return lods[lodLevel];
+    }
+
+    // model space bounding sphere of the vertices
+    glm::vec3 getBoundsCenter() const {
+        return boundsCenter;
+    }
+
+    float getBoundsRadius() const {
+        return boundsRadius;
+    }
+
+    // counts of the uploaded geometry, still valid after releaseCpuData
+    uint32_t getVertexCount() const {
+        return vertexCount;
+    }
+
+    uint32_t getIndexCount() const {
+        return indexCount;
+    }
+
+    VertexFormat vertexFormat() const {
+        return format;
+    }
+
+    // current location of the mesh in its arena, only valid until the arena relocates
+    GeometryRange geometryRange() const {
+        return geometry.range();
+    }
+
+private:
+    // render data, a range of the shared arena of the mesh's vertex format
+    MeshGeometry geometry;
+    VertexFormat format;
+    // "material.<type>" per texture, hashed once so drawing doesn't build names
+    std::vector<UniformId> samplerIds;
+    // quantization bounds of a Quantized16 mesh
+    PositionBounds positionBounds;
+    unsigned int lodLevel = 0;
+    glm::vec3 boundsCenter = glm::vec3(0.0f);
+    float boundsRadius = 0.0f;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+
+    void setupMesh(const Vertex* vertexData, size_t vertexDataCount, const unsigned int* indexData, size_t indexDataCount) {
+        vertexCount = static_cast<uint32_t>(vertexDataCount);
+        indexCount = static_cast<uint32_t>(indexDataCount);
+
+        if (lods.empty()) {
+            lods.push_back({0, indexCount, 0.0f});
+        }
+
+        samplerIds.reserve(textures.size());
+        for (const Texture& texture : textures) {
+            samplerIds.push_back("material"_u.member(texture.type));
+        }
+
+        if (vertexCount > 0) {
+            glm::vec3 min = vertexData[0].position;
+            glm::vec3 max = vertexData[0].position;
+            for (size_t i = 1; i < vertexCount; i++) {
+                min = glm::min(min, vertexData[i].position);
+                max = glm::max(max, vertexData[i].position);
+            }
+            boundsCenter = (min + max) * 0.5f;
+            boundsRadius = glm::length(max - min) * 0.5f;
+        }
+
+        uint32_t allocation;
+        if (format == VertexFormat::Quantized16) {
+            positionBounds = VertexQuantization::computeBounds(vertexData, vertexCount);
+            std::vector<QuantizedVertex> quantized = VertexQuantization::quantize(vertexData, vertexCount, positionBounds);
+            allocation = GeometryArena<QuantizedVertex>::shared().allocate(quantized.data(), vertexCount, indexData, indexCount);
+        } else {
+            allocation = GeometryArena<Vertex>::shared().allocate(vertexData, vertexCount, indexData, indexCount);
+        }
+        geometry = MeshGeometry(format, allocation);
+    }
+
+};
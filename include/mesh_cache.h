@@ -0,0 +1,367 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "mapped_file.h"
+#include "mesh.h"
+
+/**
+ * Identifies the source a mesh cache was built from and how it was processed.
+ * A cache file is only used when every field matches.
+ */
+struct MeshCacheKey {
+    std::string sourcePath;
+    int64_t sourceTime = 0;
+    uint32_t importFlags = 0;
+    // MeshCache::process* bits for the steps run after the import
+    uint32_t processFlags = 0;
+    // LOD generation settings, only meaningful with processLods
+    uint32_t lodLevels = 0;
+    float lodTargetError = 0.0f;
+};
+
+struct CachedTextureRef {
+    std::string type;
+    std::string path;
+};
+
+/**
+ * View of a single mesh stored in a mapped cache file.
+ * The vertex and index pointers point into the mapping, they are only valid while the cache is open.
+ */
+struct CachedMesh {
+    const Vertex* vertices = nullptr;
+    uint32_t vertexCount = 0;
+    const unsigned int* indices = nullptr;
+    uint32_t indexCount = 0;
+    std::vector<CachedTextureRef> textures;
+    std::vector<MeshLod> lods;
+};
+
+/**
+ * Versioned binary cache of already processed model meshes.
+ *
+ * File layout (native endianness):
+ *   FileHeader | source path | MeshRecord + texture strings + MeshLods (per mesh) | vertex/index data
+ * Vertex and index arrays are stored interleaved exactly as uploaded, 16 byte aligned,
+ * so a warm load maps the file and hands the arrays straight to glBufferData.
+ */
+class MeshCache {
+public:
+    static constexpr uint32_t version = 3;
+
+    static constexpr uint32_t processOptimized = 1u << 0;
+    static constexpr uint32_t processLods = 1u << 1;
+
+    static std::string cachePathFor(const std::string& sourcePath) {
+        return sourcePath + ".meshcache";
+    }
+
+    /**
+     * Builds the key for the current state of the source file, returns false if it can't be stat'ed.
+     */
+    static bool makeKey(const std::string& sourcePath, uint32_t importFlags, uint32_t processFlags, MeshCacheKey& key) {
+        std::error_code error;
+        auto writeTime = std::filesystem::last_write_time(sourcePath, error);
+        if (error) {
+            return false;
+        }
+
+        key.sourcePath = sourcePath;
+        key.sourceTime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+        key.importFlags = importFlags;
+        key.processFlags = processFlags;
+        return true;
+    }
+
+    /**
+     * Maps the cache file and validates it against key.
+     * Returns false (and leaves the cache closed) on a missing, stale or malformed file.
+     */
+    bool open(const std::string& cachePath, const MeshCacheKey& key) {
+        close();
+
+        if (!file_.open(cachePath) || !parse(key)) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        meshes_.clear();
+        file_.close();
+    }
+
+    const std::vector<CachedMesh>& meshes() const {
+        return meshes_;
+    }
+
+    /**
+     * Writes meshes to cachePath. The file is written to a temporary path and renamed,
+     * so a concurrent reader never observes a partially written cache.
+     */
+    static bool write(const std::string& cachePath, const MeshCacheKey& key, const std::vector<Mesh>& meshes) {
+        std::vector<unsigned char> header;
+
+        FileHeader fileHeader{};
+        std::memcpy(fileHeader.magic, magic, sizeof(magic));
+        fileHeader.version = version;
+        fileHeader.importFlags = key.importFlags;
+        fileHeader.processFlags = key.processFlags;
+        fileHeader.meshCount = static_cast<uint32_t>(meshes.size());
+        fileHeader.lodLevels = key.lodLevels;
+        fileHeader.lodTargetError = key.lodTargetError;
+        fileHeader.sourceTime = key.sourceTime;
+        fileHeader.sourcePathLength = static_cast<uint32_t>(key.sourcePath.size());
+        fileHeader.vertexSize = sizeof(Vertex);
+        append(header, &fileHeader, sizeof(fileHeader));
+        append(header, key.sourcePath.data(), key.sourcePath.size());
+
+        // mesh records are patched with their data offsets once the header size is known
+        std::vector<size_t> recordPositions;
+        for (const Mesh& mesh : meshes) {
+            MeshRecord record{};
+            record.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+            record.indexCount = static_cast<uint32_t>(mesh.indices.size());
+            record.textureCount = static_cast<uint32_t>(mesh.textures.size());
+            record.lodCount = static_cast<uint32_t>(mesh.lods.size());
+            recordPositions.push_back(header.size());
+            append(header, &record, sizeof(record));
+
+            for (const Texture& texture : mesh.textures) {
+                appendString(header, texture.type);
+                appendString(header, texture.path);
+            }
+            append(header, mesh.lods.data(), mesh.lods.size() * sizeof(MeshLod));
+        }
+
+        uint64_t dataOffset = alignUp(header.size());
+        for (size_t i = 0; i < meshes.size(); i++) {
+            MeshRecord record;
+            std::memcpy(&record, header.data() + recordPositions[i], sizeof(record));
+            record.vertexOffset = dataOffset;
+            dataOffset = alignUp(dataOffset + meshes[i].vertices.size() * sizeof(Vertex));
+            record.indexOffset = dataOffset;
+            dataOffset = alignUp(dataOffset + meshes[i].indices.size() * sizeof(unsigned int));
+            std::memcpy(header.data() + recordPositions[i], &record, sizeof(record));
+        }
+
+        std::string tempPath = cachePath + ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                return false;
+            }
+
+            out.write(reinterpret_cast<const char*>(header.data()), header.size());
+            writePadding(out, header.size());
+            for (const Mesh& mesh : meshes) {
+                size_t vertexBytes = mesh.vertices.size() * sizeof(Vertex);
+                out.write(reinterpret_cast<const char*>(mesh.vertices.data()), vertexBytes);
+                writePadding(out, vertexBytes);
+
+                size_t indexBytes = mesh.indices.size() * sizeof(unsigned int);
+                out.write(reinterpret_cast<const char*>(mesh.indices.data()), indexBytes);
+                writePadding(out, indexBytes);
+            }
+
+            if (!out) {
+                out.close();
+                std::remove(tempPath.c_str());
+                return false;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempPath, cachePath, error);
+        if (error) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr char magic[4] = {'M', 'S', 'H', 'C'};
+    static constexpr size_t dataAlignment = 16;
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t importFlags;
+        uint32_t processFlags;
+        uint32_t meshCount;
+        uint32_t lodLevels;
+        int64_t sourceTime;
+        uint32_t sourcePathLength;
+        uint32_t vertexSize;
+        float lodTargetError;
+        uint32_t reserved;
+    };
+
+    struct MeshRecord {
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t textureCount;
+        uint32_t lodCount;
+        uint64_t vertexOffset;
+        uint64_t indexOffset;
+    };
+
+    MappedFile file_;
+    std::vector<CachedMesh> meshes_;
+
+    /**
+     * Bounds checked sequential reader over the mapping.
+     */
+    class Reader {
+    public:
+        Reader(const unsigned char* data, size_t size) : data_(data), size_(size) {}
+
+        bool read(void* out, size_t bytes) {
+            if (bytes > size_ - position_) {
+                return false;
+            }
+            std::memcpy(out, data_ + position_, bytes);
+            position_ += bytes;
+            return true;
+        }
+
+        bool readString(std::string& out, size_t length) {
+            if (length > size_ - position_) {
+                return false;
+            }
+            out.assign(reinterpret_cast<const char*>(data_ + position_), length);
+            position_ += length;
+            return true;
+        }
+
+        // bytes left to read
+        size_t remaining() const {
+            return size_ - position_;
+        }
+
+    private:
+        const unsigned char* data_;
+        size_t size_;
+        size_t position_ = 0;
+    };
+
+    bool parse(const MeshCacheKey& key) {
+        Reader reader(file_.data(), file_.size());
+
+        FileHeader fileHeader;
+        if (!reader.read(&fileHeader, sizeof(fileHeader))) {
+            return false;
+        }
+        if (std::memcmp(fileHeader.magic, magic, sizeof(magic)) != 0
+            || fileHeader.version != version
+            || fileHeader.vertexSize != sizeof(Vertex)
+            || fileHeader.importFlags != key.importFlags
+            || fileHeader.processFlags != key.processFlags
+            || fileHeader.lodLevels != key.lodLevels
+            || fileHeader.lodTargetError != key.lodTargetError
+            || fileHeader.sourceTime != key.sourceTime) {
+            return false;
+        }
+
+        std::string sourcePath;
+        if (!reader.readString(sourcePath, fileHeader.sourcePathLength) || sourcePath != key.sourcePath) {
+            return false;
+        }
+
+        // bound the counts by the bytes left before allocating for them, every record and string length is read from there
+        if (fileHeader.meshCount > reader.remaining() / sizeof(MeshRecord)) {
+            return false;
+        }
+        meshes_.resize(fileHeader.meshCount);
+        for (CachedMesh& mesh : meshes_) {
+            MeshRecord record;
+            if (!reader.read(&record, sizeof(record))) {
+                return false;
+            }
+
+            // each texture has at least its two string lengths
+            if (record.textureCount > reader.remaining() / (2 * sizeof(uint32_t))) {
+                return false;
+            }
+            mesh.textures.resize(record.textureCount);
+            for (CachedTextureRef& texture : mesh.textures) {
+                uint32_t length;
+                if (!reader.read(&length, sizeof(length)) || !reader.readString(texture.type, length)) {
+                    return false;
+                }
+                if (!reader.read(&length, sizeof(length)) || !reader.readString(texture.path, length)) {
+                    return false;
+                }
+            }
+
+            if (record.lodCount > reader.remaining() / sizeof(MeshLod)) {
+                return false;
+            }
+            mesh.lods.resize(record.lodCount);
+            if (!reader.read(mesh.lods.data(), mesh.lods.size() * sizeof(MeshLod))) {
+                return false;
+            }
+            for (const MeshLod& lod : mesh.lods) {
+                if (lod.firstIndex > record.indexCount || lod.indexCount > record.indexCount - lod.firstIndex) {
+                    return false;
+                }
+            }
+
+            uint64_t vertexBytes = uint64_t(record.vertexCount) * sizeof(Vertex);
+            uint64_t indexBytes = uint64_t(record.indexCount) * sizeof(unsigned int);
+            if (!inBounds(record.vertexOffset, vertexBytes) || !inBounds(record.indexOffset, indexBytes)) {
+                return false;
+            }
+            if (record.vertexOffset % alignof(Vertex) != 0 || record.indexOffset % alignof(unsigned int) != 0) {
+                return false;
+            }
+
+            mesh.vertices = reinterpret_cast<const Vertex*>(file_.data() + record.vertexOffset);
+            mesh.vertexCount = record.vertexCount;
+            mesh.indices = reinterpret_cast<const unsigned int*>(file_.data() + record.indexOffset);
+            mesh.indexCount = record.indexCount;
+
+            for (uint32_t i = 0; i < mesh.indexCount; i++) {
+                if (mesh.indices[i] >= mesh.vertexCount) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool inBounds(uint64_t offset, uint64_t bytes) const {
+        return offset <= file_.size() && bytes <= file_.size() - offset;
+    }
+
+    static uint64_t alignUp(uint64_t value) {
+        return (value + dataAlignment - 1) & ~uint64_t(dataAlignment - 1);
+    }
+
+    static void append(std::vector<unsigned char>& buffer, const void* data, size_t bytes) {
+        const unsigned char* begin = static_cast<const unsigned char*>(data);
+        buffer.insert(buffer.end(), begin, begin + bytes);
+    }
+
+    static void appendString(std::vector<unsigned char>& buffer, const std::string& str) {
+        uint32_t length = static_cast<uint32_t>(str.size());
+        append(buffer, &length, sizeof(length));
+        append(buffer, str.data(), str.size());
+    }
+
+    static void writePadding(std::ofstream& out, uint64_t writtenBytes) {
+        static const char zeros[dataAlignment] = {};
+        out.write(zeros, alignUp(writtenBytes) - writtenBytes);
+    }
+};
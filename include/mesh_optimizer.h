@@ -0,0 +1,383 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "mesh.h"
+
+/**
+ * Post-transform vertex cache statistics of an indexed triangle list.
+ * Counts are kept raw so stats of several meshes can be summed before computing ratios.
+ */
+struct VertexCacheStats {
+    size_t triangles = 0;
+    size_t vertices = 0;
+    // vertex shader invocations, i.e. cache misses
+    size_t transforms = 0;
+
+    // average cache miss ratio, transformed vertices per triangle (best case ~0.5, worst 3)
+    float acmr() const {
+        return triangles ? float(transforms) / float(triangles) : 0.0f;
+    }
+
+    // average transform to vertex ratio (best case 1)
+    float atvr() const {
+        return vertices ? float(transforms) / float(vertices) : 0.0f;
+    }
+
+    VertexCacheStats& operator+=(const VertexCacheStats& other) {
+        triangles += other.triangles;
+        vertices += other.vertices;
+        transforms += other.transforms;
+        return *this;
+    }
+};
+
+struct MeshOptimizationStats {
+    VertexCacheStats before;
+    VertexCacheStats after;
+
+    MeshOptimizationStats& operator+=(const MeshOptimizationStats& other) {
+        before += other.before;
+        after += other.after;
+        return *this;
+    }
+};
+
+namespace MeshOptimizer {
+
+    // size of the FIFO used to report ACMR/ATVR, matches common desktop GPUs
+    constexpr size_t analysisCacheSize = 16;
+    // size of the LRU cache modelled while reordering triangles
+    constexpr size_t optimizerCacheSize = 32;
+
+    /**
+     * Simulates a FIFO post-transform cache over the index buffer.
+     */
+    inline VertexCacheStats analyzeVertexCache(
+        const std::vector<unsigned int>& indices, size_t vertexCount, size_t cacheSize = analysisCacheSize
+    ) {
+        VertexCacheStats stats;
+        stats.triangles = indices.size() / 3;
+        stats.vertices = vertexCount;
+
+        // a vertex is in the cache if it entered less than cacheSize misses ago
+        std::vector<size_t> entryTime(vertexCount, 0);
+        size_t time = cacheSize + 1;
+        for (unsigned int index : indices) {
+            if (time - entryTime[index] > cacheSize) {
+                entryTime[index] = time++;
+            }
+        }
+        stats.transforms = time - (cacheSize + 1);
+        return stats;
+    }
+
+    /**
+     * Merges bitwise identical vertices and remaps the indices onto the unique set.
+     */
+    inline void weldVertices(MeshData& mesh) {
+        struct VertexHash {
+            size_t operator()(const Vertex& vertex) const {
+                const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&vertex);
+                // FNV-1a over the raw vertex
+                uint64_t hash = 14695981039346656037ull;
+                for (size_t i = 0; i < sizeof(Vertex); i++) {
+                    hash = (hash ^ bytes[i]) * 1099511628211ull;
+                }
+                return static_cast<size_t>(hash);
+            }
+        };
+        struct VertexEqual {
+            bool operator()(const Vertex& a, const Vertex& b) const {
+                return std::memcmp(&a, &b, sizeof(Vertex)) == 0;
+            }
+        };
+
+        std::unordered_map<Vertex, unsigned int, VertexHash, VertexEqual> unique;
+        unique.reserve(mesh.vertices.size());
+
+        std::vector<unsigned int> remap(mesh.vertices.size());
+        std::vector<Vertex> vertices;
+        vertices.reserve(mesh.vertices.size());
+
+        for (size_t i = 0; i < mesh.vertices.size(); i++) {
+            auto inserted = unique.emplace(mesh.vertices[i], static_cast<unsigned int>(vertices.size()));
+            if (inserted.second) {
+                vertices.push_back(mesh.vertices[i]);
+            }
+            remap[i] = inserted.first->second;
+        }
+
+        for (unsigned int& index : mesh.indices) {
+            index = remap[index];
+        }
+        mesh.vertices = std::move(vertices);
+    }
+
+    /**
+     * Reorders triangles for post-transform cache locality (Tom Forsyth's linear-speed optimizer).
+     * Each step emits the triangle whose vertices score highest given an LRU cache model,
+     * favouring vertices that are in the cache and vertices with few remaining triangles.
+     */
+    inline std::vector<unsigned int> optimizeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount) {
+        const size_t triangleCount = indices.size() / 3;
+        const size_t cacheSize = optimizerCacheSize;
+
+        auto vertexScore = [cacheSize](int cachePosition, unsigned int remaining) {
+            if (remaining == 0) {
+                return -1.0f;
+            }
+
+            float score = 0.0f;
+            if (cachePosition >= 0) {
+                if (cachePosition < 3) {
+                    // the last triangle's vertices, deliberately not the best so strips don't go backwards
+                    score = 0.75f;
+                } else {
+                    float scaler = 1.0f / float(cacheSize - 3);
+                    score = std::pow(1.0f - float(cachePosition - 3) * scaler, 1.5f);
+                }
+            }
+            // boost vertices with few triangles left so they get finished off
+            score += 2.0f / std::sqrt(float(remaining));
+            return score;
+        };
+
+        // vertex -> triangle adjacency, the live triangles of v are adjacency[offsets[v], offsets[v] + remaining[v])
+        std::vector<unsigned int> remaining(vertexCount, 0);
+        for (unsigned int index : indices) {
+            remaining[index]++;
+        }
+        std::vector<unsigned int> offsets(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; v++) {
+            offsets[v + 1] = offsets[v] + remaining[v];
+        }
+        std::vector<unsigned int> adjacency(indices.size());
+        {
+            std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++) {
+                adjacency[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+            }
+        }
+
+        std::vector<int> cachePosition(vertexCount, -1);
+        std::vector<float> scores(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++) {
+            scores[v] = vertexScore(-1, remaining[v]);
+        }
+
+        std::vector<float> triangleScores(triangleCount);
+        std::vector<bool> emitted(triangleCount, false);
+        for (size_t t = 0; t < triangleCount; t++) {
+            triangleScores[t] = scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+        }
+
+        std::vector<unsigned int> cache;
+        std::vector<unsigned int> newCache;
+        cache.reserve(cacheSize + 3);
+        newCache.reserve(cacheSize + 3);
+
+        std::vector<unsigned int> result;
+        result.reserve(triangleCount * 3);
+
+        size_t inputCursor = 0;
+        long bestTriangle = triangleCount > 0 ? 0 : -1;
+
+        while (result.size() < triangleCount * 3) {
+            if (bestTriangle < 0) {
+                // no candidate in the cache, continue with the next triangle in input order
+                while (emitted[inputCursor]) {
+                    inputCursor++;
+                }
+                bestTriangle = static_cast<long>(inputCursor);
+            }
+
+            const unsigned int* triangle = &indices[bestTriangle * 3];
+            emitted[bestTriangle] = true;
+            result.insert(result.end(), triangle, triangle + 3);
+
+            for (int k = 0; k < 3; k++) {
+                unsigned int v = triangle[k];
+                unsigned int* begin = &adjacency[offsets[v]];
+                unsigned int* end = begin + remaining[v];
+                unsigned int* found = std::find(begin, end, static_cast<unsigned int>(bestTriangle));
+                if (found != end) {
+                    std::swap(*found, *(end - 1));
+                    remaining[v]--;
+                }
+            }
+
+            // move the triangle's vertices to the front of the LRU cache
+            newCache.assign(triangle, triangle + 3);
+            for (unsigned int v : cache) {
+                if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                    newCache.push_back(v);
+                }
+            }
+            for (size_t i = cacheSize; i < newCache.size(); i++) {
+                cachePosition[newCache[i]] = -1;
+            }
+
+            // rescore every vertex whose cache position changed (including evicted ones)
+            for (size_t i = 0; i < newCache.size(); i++) {
+                unsigned int v = newCache[i];
+                if (i < cacheSize) {
+                    cachePosition[v] = static_cast<int>(i);
+                }
+
+                float score = vertexScore(cachePosition[v], remaining[v]);
+                float delta = score - scores[v];
+                scores[v] = score;
+                for (unsigned int j = 0; j < remaining[v]; j++) {
+                    triangleScores[adjacency[offsets[v] + j]] += delta;
+                }
+            }
+
+            if (newCache.size() > cacheSize) {
+                newCache.resize(cacheSize);
+            }
+            cache.swap(newCache);
+
+            // the next triangle is picked among the ones touching the cache
+            bestTriangle = -1;
+            float bestScore = 0.0f;
+            for (unsigned int v : cache) {
+                for (unsigned int j = 0; j < remaining[v]; j++) {
+                    unsigned int t = adjacency[offsets[v] + j];
+                    if (triangleScores[t] > bestScore) {
+                        bestScore = triangleScores[t];
+                        bestTriangle = static_cast<long>(t);
+                    }
+                }
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * Reorders clusters of triangles to reduce overdraw, keeping most of the cache locality.
+     * The (already cache optimized) index buffer is split where the cache simulation restarts,
+     * then clusters facing away from the mesh centre are drawn first since they tend to occlude the rest.
+     */
+    inline void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices) {
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0) {
+            return;
+        }
+
+        // cluster boundaries: triangles where all three vertices miss the cache
+        std::vector<size_t> clusterStarts;
+        {
+            std::vector<size_t> entryTime(vertices.size(), 0);
+            const size_t cacheSize = analysisCacheSize;
+            size_t time = cacheSize + 1;
+            for (size_t t = 0; t < triangleCount; t++) {
+                int misses = 0;
+                for (int k = 0; k < 3; k++) {
+                    unsigned int v = indices[t * 3 + k];
+                    if (time - entryTime[v] > cacheSize) {
+                        entryTime[v] = time++;
+                        misses++;
+                    }
+                }
+                if (t == 0 || misses == 3) {
+                    clusterStarts.push_back(t);
+                }
+            }
+        }
+        clusterStarts.push_back(triangleCount);
+
+        glm::vec3 meshCentroid(0.0f);
+        for (unsigned int index : indices) {
+            meshCentroid += vertices[index].position;
+        }
+        meshCentroid /= float(indices.size());
+
+        struct Cluster {
+            size_t begin;
+            size_t end;
+            float sortKey;
+        };
+        std::vector<Cluster> clusters;
+        for (size_t c = 0; c + 1 < clusterStarts.size(); c++) {
+            glm::vec3 centroid(0.0f);
+            glm::vec3 normal(0.0f);
+            float totalArea = 0.0f;
+            for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++) {
+                const glm::vec3& p0 = vertices[indices[t * 3]].position;
+                const glm::vec3& p1 = vertices[indices[t * 3 + 1]].position;
+                const glm::vec3& p2 = vertices[indices[t * 3 + 2]].position;
+                // area weighted centroid and normal
+                glm::vec3 areaNormal = glm::cross(p1 - p0, p2 - p0);
+                float area = glm::length(areaNormal);
+                centroid += (p0 + p1 + p2) * (area / 3.0f);
+                normal += areaNormal;
+                totalArea += area;
+            }
+
+            float sortKey = 0.0f;
+            float normalLength = glm::length(normal);
+            if (totalArea > 0.0f && normalLength > 0.0f) {
+                centroid /= totalArea;
+                sortKey = glm::dot(centroid - meshCentroid, normal / normalLength);
+            }
+            clusters.push_back({clusterStarts[c], clusterStarts[c + 1], sortKey});
+        }
+
+        std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) {
+            return a.sortKey > b.sortKey;
+        });
+
+        std::vector<unsigned int> result;
+        result.reserve(indices.size());
+        for (const Cluster& cluster : clusters) {
+            result.insert(result.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+        }
+        indices = std::move(result);
+    }
+
+    /**
+     * Reorders vertices in the order the index buffer first references them, dropping unused vertices.
+     */
+    inline void optimizeVertexFetch(MeshData& mesh) {
+        const unsigned int unused = ~0u;
+        std::vector<unsigned int> remap(mesh.vertices.size(), unused);
+        std::vector<Vertex> vertices;
+        vertices.reserve(mesh.vertices.size());
+
+        for (unsigned int& index : mesh.indices) {
+            if (remap[index] == unused) {
+                remap[index] = static_cast<unsigned int>(vertices.size());
+                vertices.push_back(mesh.vertices[index]);
+            }
+            index = remap[index];
+        }
+        mesh.vertices = std::move(vertices);
+    }
+
+    /**
+     * Runs the full pass: weld, cache order, overdraw order, fetch order.
+     */
+    inline MeshOptimizationStats optimize(MeshData& mesh) {
+        MeshOptimizationStats stats;
+        stats.before = analyzeVertexCache(mesh.indices, mesh.vertices.size());
+
+        weldVertices(mesh);
+        mesh.indices = optimizeVertexCache(mesh.indices, mesh.vertices.size());
+        optimizeOverdraw(mesh.indices, mesh.vertices);
+        optimizeVertexFetch(mesh);
+
+        stats.after = analyzeVertexCache(mesh.indices, mesh.vertices.size());
+        return stats;
+    }
+
+}
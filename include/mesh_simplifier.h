@@ -0,0 +1,369 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "mesh.h"
+#include "mesh_optimizer.h"
+
+namespace MeshSimplifier {
+
+    /**
+     * Sum of squared distances to a set of planes, weighted by triangle area (Garland & Heckbert).
+     * The symmetric 4x4 matrix is stored as its 10 unique entries.
+     */
+    struct Quadric {
+        double a2 = 0, b2 = 0, c2 = 0, d2 = 0;
+        double ab = 0, ac = 0, ad = 0, bc = 0, bd = 0, cd = 0;
+        double weight = 0;
+
+        static Quadric fromPlane(glm::dvec3 normal, double distance, double weight) {
+            Quadric q;
+            q.a2 = normal.x * normal.x * weight;
+            q.b2 = normal.y * normal.y * weight;
+            q.c2 = normal.z * normal.z * weight;
+            q.d2 = distance * distance * weight;
+            q.ab = normal.x * normal.y * weight;
+            q.ac = normal.x * normal.z * weight;
+            q.ad = normal.x * distance * weight;
+            q.bc = normal.y * normal.z * weight;
+            q.bd = normal.y * distance * weight;
+            q.cd = normal.z * distance * weight;
+            q.weight = weight;
+            return q;
+        }
+
+        Quadric& operator+=(const Quadric& other) {
+            a2 += other.a2; b2 += other.b2; c2 += other.c2; d2 += other.d2;
+            ab += other.ab; ac += other.ac; ad += other.ad;
+            bc += other.bc; bd += other.bd; cd += other.cd;
+            weight += other.weight;
+            return *this;
+        }
+
+        // area weighted mean squared distance of p to the planes
+        double error(glm::dvec3 p) const {
+            double sum = a2 * p.x * p.x + b2 * p.y * p.y + c2 * p.z * p.z + d2
+                + 2.0 * (ab * p.x * p.y + ac * p.x * p.z + bc * p.y * p.z)
+                + 2.0 * (ad * p.x + bd * p.y + cd * p.z);
+            return weight > 0.0 ? std::max(sum, 0.0) / weight : 0.0;
+        }
+    };
+
+    struct Collapse {
+        unsigned int from;
+        unsigned int to;
+        double error;
+    };
+
+    inline void considerCollapse(Collapse& best, const Collapse& candidate) {
+        if (best.error < 0.0 || candidate.error < best.error) {
+            best = candidate;
+        }
+    }
+
+    /**
+     * Maps every vertex to the first vertex with the same position, so attribute seams share one quadric.
+     */
+    inline std::vector<unsigned int> positionRemap(const std::vector<Vertex>& vertices) {
+        struct PositionHash {
+            size_t operator()(const glm::vec3& p) const {
+                uint32_t bits[3];
+                std::memcpy(bits, &p, sizeof(bits));
+                return size_t(bits[0]) * 73856093u ^ size_t(bits[1]) * 19349663u ^ size_t(bits[2]) * 83492791u;
+            }
+        };
+
+        std::unordered_map<glm::vec3, unsigned int, PositionHash> first;
+        first.reserve(vertices.size());
+
+        std::vector<unsigned int> remap(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            remap[i] = first.emplace(vertices[i].position, static_cast<unsigned int>(i)).first->second;
+        }
+        return remap;
+    }
+
+    /**
+     * Marks the positions that must not be collapsed away: attribute seams (several vertices share
+     * the position) and open or non-manifold edges, where removing a vertex would change the outline.
+     */
+    inline std::vector<bool> lockedPositions(const std::vector<unsigned int>& indices, const std::vector<unsigned int>& remap) {
+        std::vector<bool> locked(remap.size(), false);
+
+        // the vertex first seen at each position, a second one makes it a seam
+        std::vector<unsigned int> wedge(remap.size(), UINT32_MAX);
+        for (unsigned int index : indices) {
+            unsigned int position = remap[index];
+            if (wedge[position] == UINT32_MAX) {
+                wedge[position] = index;
+            } else if (wedge[position] != index) {
+                locked[position] = true;
+            }
+        }
+
+        std::unordered_map<uint64_t, unsigned int> edges;
+        edges.reserve(indices.size());
+        auto edgeKey = [](unsigned int a, unsigned int b) {
+            return (uint64_t(a) << 32) | b;
+        };
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            for (int e = 0; e < 3; e++) {
+                edges[edgeKey(remap[indices[i + e]], remap[indices[i + (e + 1) % 3]])]++;
+            }
+        }
+
+        for (const auto& edge : edges) {
+            unsigned int a = static_cast<unsigned int>(edge.first >> 32);
+            unsigned int b = static_cast<unsigned int>(edge.first & 0xffffffffu);
+            auto opposite = edges.find(edgeKey(b, a));
+            if (edge.second != 1 || opposite == edges.end() || opposite->second != 1) {
+                locked[a] = true;
+                locked[b] = true;
+            }
+        }
+        return locked;
+    }
+
+    /**
+     * Simplifies an indexed triangle list by collapsing edges onto existing vertices, cheapest quadric error first,
+     * until it has at most targetIndexCount indices or no collapse stays within targetError.
+     * The vertex buffer is left untouched, only a new index list is returned.
+     *
+     * targetError is relative to the largest extent of the mesh bounds, resultError (if given)
+     * receives the largest error of an applied collapse in the same units.
+     * Attribute seams and open edges are kept in place.
+     */
+    inline std::vector<unsigned int> simplify(
+        const std::vector<unsigned int>& sourceIndices, const std::vector<Vertex>& vertices,
+        size_t targetIndexCount, float targetError, float* resultError = nullptr
+    ) {
+        std::vector<unsigned int> indices = sourceIndices;
+        double maxError = 0.0;
+
+        if (indices.size() <= targetIndexCount || vertices.empty()) {
+            if (resultError) {
+                *resultError = 0.0f;
+            }
+            return indices;
+        }
+
+        // positions normalized to the unit cube, so errors are relative to the mesh size
+        glm::vec3 min = vertices[0].position;
+        glm::vec3 max = vertices[0].position;
+        for (const Vertex& vertex : vertices) {
+            min = glm::min(min, vertex.position);
+            max = glm::max(max, vertex.position);
+        }
+        glm::vec3 extent = max - min;
+        double scale = 1.0 / std::max({double(extent.x), double(extent.y), double(extent.z), 1e-20});
+
+        std::vector<glm::dvec3> positions(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            positions[i] = glm::dvec3(vertices[i].position - min) * scale;
+        }
+
+        std::vector<unsigned int> remap = positionRemap(vertices);
+        std::vector<bool> locked = lockedPositions(indices, remap);
+
+        std::vector<Quadric> quadrics(vertices.size());
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            glm::dvec3 p0 = positions[indices[i]];
+            glm::dvec3 normal = glm::cross(positions[indices[i + 1]] - p0, positions[indices[i + 2]] - p0);
+            double length = glm::length(normal);
+            if (length == 0.0) {
+                continue;
+            }
+            normal /= length;
+
+            Quadric plane = Quadric::fromPlane(normal, -glm::dot(normal, p0), length * 0.5);
+            for (int k = 0; k < 3; k++) {
+                quadrics[remap[indices[i + k]]] += plane;
+            }
+        }
+
+        double errorLimit = double(targetError) * double(targetError);
+
+        std::vector<unsigned int> triangleOffsets(vertices.size() + 1);
+        std::vector<unsigned int> vertexTriangles;
+        std::vector<Collapse> bestCollapse(vertices.size());
+        std::vector<Collapse> collapses;
+        std::vector<bool> touched(vertices.size());
+
+        // each pass applies a set of independent collapses, then rebuilds the adjacency
+        while (indices.size() > targetIndexCount) {
+            size_t triangleCount = indices.size() / 3;
+
+            std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+            for (unsigned int index : indices) {
+                triangleOffsets[index + 1]++;
+            }
+            for (size_t i = 0; i < vertices.size(); i++) {
+                triangleOffsets[i + 1] += triangleOffsets[i];
+            }
+            vertexTriangles.resize(indices.size());
+            std::vector<unsigned int> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++) {
+                vertexTriangles[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+            }
+
+            // only the cheapest collapse of every vertex is a candidate
+            std::fill(bestCollapse.begin(), bestCollapse.end(), Collapse{0, 0, -1.0});
+            for (size_t i = 0; i < indices.size(); i += 3) {
+                for (int e = 0; e < 3; e++) {
+                    unsigned int a = indices[i + e];
+                    unsigned int b = indices[i + (e + 1) % 3];
+                    unsigned int positionA = remap[a];
+                    unsigned int positionB = remap[b];
+                    if (locked[positionA] && locked[positionB]) {
+                        continue;
+                    }
+
+                    Quadric combined = quadrics[positionA];
+                    combined += quadrics[positionB];
+                    if (!locked[positionA]) {
+                        considerCollapse(bestCollapse[a], {a, b, combined.error(positions[b])});
+                    }
+                    if (!locked[positionB]) {
+                        considerCollapse(bestCollapse[b], {b, a, combined.error(positions[a])});
+                    }
+                }
+            }
+
+            collapses.clear();
+            for (const Collapse& collapse : bestCollapse) {
+                if (collapse.error >= 0.0 && collapse.error <= errorLimit) {
+                    collapses.push_back(collapse);
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) {
+                return x.error < y.error;
+            });
+
+            std::fill(touched.begin(), touched.end(), false);
+            size_t removedTriangles = 0;
+            size_t appliedCollapses = 0;
+
+            for (const Collapse& collapse : collapses) {
+                if ((triangleCount - removedTriangles) * 3 <= targetIndexCount) {
+                    break;
+                }
+                if (touched[collapse.from] || touched[collapse.to]) {
+                    continue;
+                }
+
+                // reject collapses that flip a remaining triangle around the removed vertex
+                bool flips = false;
+                size_t degenerate = 0;
+                for (unsigned int t = triangleOffsets[collapse.from]; t < triangleOffsets[collapse.from + 1] && !flips; t++) {
+                    const unsigned int* triangle = &indices[size_t(vertexTriangles[t]) * 3];
+                    if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) {
+                        degenerate++;
+                        continue;
+                    }
+
+                    glm::dvec3 before[3], after[3];
+                    for (int k = 0; k < 3; k++) {
+                        before[k] = positions[triangle[k]];
+                        after[k] = triangle[k] == collapse.from ? positions[collapse.to] : before[k];
+                    }
+                    glm::dvec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+                    glm::dvec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+                    flips = glm::dot(normalBefore, normalAfter) <= 0.0;
+                }
+                if (flips) {
+                    continue;
+                }
+
+                for (unsigned int t = triangleOffsets[collapse.from]; t < triangleOffsets[collapse.from + 1]; t++) {
+                    unsigned int* triangle = &indices[size_t(vertexTriangles[t]) * 3];
+                    for (int k = 0; k < 3; k++) {
+                        touched[triangle[k]] = true;
+                        if (triangle[k] == collapse.from) {
+                            triangle[k] = collapse.to;
+                        }
+                    }
+                }
+
+                quadrics[remap[collapse.to]] += quadrics[remap[collapse.from]];
+                maxError = std::max(maxError, collapse.error);
+                removedTriangles += degenerate;
+                appliedCollapses++;
+            }
+
+            if (appliedCollapses == 0) {
+                break;
+            }
+
+            // drop the triangles that collapsed to a line
+            size_t write = 0;
+            for (size_t i = 0; i < indices.size(); i += 3) {
+                unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+                if (remap[a] == remap[b] || remap[b] == remap[c] || remap[a] == remap[c]) {
+                    continue;
+                }
+                indices[write++] = a;
+                indices[write++] = b;
+                indices[write++] = c;
+            }
+            indices.resize(write);
+        }
+
+        if (resultError) {
+            *resultError = static_cast<float>(std::sqrt(maxError));
+        }
+        return indices;
+    }
+
+    /**
+     * Appends up to levelCount simplified index lists to mesh.indices, each targeting half the triangles
+     * of the previous level, and records every level (the full resolution one first) in mesh.lods.
+     * Every level is simplified from the previous one, so its recorded error is the sum along the chain.
+     * Generation stops early once a level can't get meaningfully smaller within targetError.
+     */
+    inline void generateLods(MeshData& mesh, unsigned int levelCount, float targetError) {
+        mesh.lods.clear();
+        mesh.lods.push_back({0, static_cast<uint32_t>(mesh.indices.size()), 0.0f});
+        if (levelCount == 0 || mesh.indices.empty()) {
+            return;
+        }
+
+        glm::vec3 min = mesh.vertices[0].position;
+        glm::vec3 max = mesh.vertices[0].position;
+        for (const Vertex& vertex : mesh.vertices) {
+            min = glm::min(min, vertex.position);
+            max = glm::max(max, vertex.position);
+        }
+        glm::vec3 extent = max - min;
+        float meshScale = std::max({extent.x, extent.y, extent.z});
+
+        std::vector<unsigned int> previous = mesh.indices;
+        float accumulatedError = 0.0f;
+
+        for (unsigned int level = 1; level <= levelCount && accumulatedError < targetError; level++) {
+            size_t target = (previous.size() / 2) / 3 * 3;
+            float error = 0.0f;
+            std::vector<unsigned int> lod = simplify(previous, mesh.vertices, target, targetError - accumulatedError, &error);
+
+            if (lod.empty() || lod.size() > previous.size() * 9 / 10) {
+                break;
+            }
+            accumulatedError += error;
+
+            lod = MeshOptimizer::optimizeVertexCache(lod, mesh.vertices.size());
+            mesh.lods.push_back({
+                static_cast<uint32_t>(mesh.indices.size()), static_cast<uint32_t>(lod.size()), accumulatedError * meshScale
+            });
+            mesh.indices.insert(mesh.indices.end(), lod.begin(), lod.end());
+            previous = std::move(lod);
+        }
+    }
+
+}
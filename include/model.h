@@ -1,126 +1,354 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
 #include <string>
 #include <vector>
 
-#include <glm/glm.hpp>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
-#include <stb_image.h>
 
-#include "shader.h"
-
-struct Vertex {
-    glm::vec3 position;
-    glm::vec3 normal;
-    glm::vec2 texCoords;
-};
-
-struct Texture {
-    unsigned int id;
-    std::string type;
-    std::string path;
+#include "camera.h"
+#include "frustum.h"
+#include "gl_extensions.h"
+#include "gl_resource.h"
+#include "mesh.h"
+#include "mesh_cache.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+#include "texture_registry.h"
+#include "thread_pool.h"
+
+struct ModelLoadOptions {
+    // load from / write to a binary cache of the processed meshes next to the source file
+    bool useMeshCache = true;
+    // convert the imported meshes on the shared worker pool, only GL setup stays on the calling thread
+    bool parallelMeshProcessing = false;
+    // flip the material textures vertically while decoding
+    bool flipTexturesVertically = false;
+    // weld duplicate vertices and reorder triangles/vertices for the post-transform cache and fetch locality
+    bool optimizeMeshes = false;
+    // GPU vertex layout of every mesh, Quantized16 must be drawn with quantized_vertex.glsl
+    VertexFormat vertexFormat = VertexFormat::Float32;
+    // simplified levels of detail generated per mesh on top of the full resolution one, each with about half the triangles
+    unsigned int lodLevels = 0;
+    // largest simplification error of a level, relative to the mesh size
+    float lodTargetError = 0.02f;
+    // a level is drawn once its error projects to at most this many pixels
+    float lodPixelError = 1.0f;
+    // fraction of lodPixelError a coarser level has to stay below before it is switched to
+    float lodHysteresis = 0.25f;
+    // keep the CPU copies of vertices and indices after upload, only needed to rebuild or re-export meshes
+    bool keepCpuData = true;
 };
 
-class Mesh {
+class Model {
 public:
-    // mesh data
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
-    std::vector<Texture> textures;
-
-    Mesh(
-        std::vector<Vertex> vertices,
-        std::vector<unsigned int> indices,
-        std::vector<Texture> textures
+    explicit Model(const std::string& path, ModelLoadOptions options = ModelLoadOptions())
+        : options(options)
+    {
+        loadModel(path);
+    }
+
+    // meshes and GL buffers are owned, so a model can only be moved
+    Model(const Model&) = delete;
+    Model& operator=(const Model&) = delete;
+
+    Model(Model&&) noexcept = default;
+    Model& operator=(Model&&) noexcept = default;
+
+    // true if the meshes were restored from the mesh cache instead of imported
+    bool loadedFromCache() const {
+        return fromCache;
+    }
+
+    // vertex cache stats of the optimization pass, empty if it didn't run (disabled or loaded from cache)
+    const MeshOptimizationStats& getOptimizationStats() const {
+        return optimizationStats;
+    }
+
+    /**
+     * Flattens the node tree into the list of meshes in draw order (depth first, node meshes before children).
+     */
+    static void collectMeshes(const aiNode* node, const aiScene* scene, std::vector<const aiMesh*>& workList) {
+        for (unsigned int i = 0; i < node->mNumMeshes; i++) {
+            workList.push_back(scene->mMeshes[node->mMeshes[i]]);
+        }
+        for (unsigned int i = 0; i < node->mNumChildren; i++) {
+            collectMeshes(node->mChildren[i], scene, workList);
+        }
+    }
+
+    /**
+     * Converts every mesh in the work list into interleaved vertex/index arrays, then runs the mesh optimizer
+     * (summing its stats into optimizationStats) and LOD generation on each as the options ask.
+     * CPU only (no GL calls), runs on the worker pool with parallelMeshProcessing.
+     * Results are stored in work list order either way.
+     */
+    static std::vector<MeshData> convertMeshes(
+        const std::vector<const aiMesh*>& workList, const ModelLoadOptions& options,
+        MeshOptimizationStats* optimizationStats = nullptr
     ) {
-        // copy the pointer (caller can manipulate this data)
-        this->vertices = vertices;
-        this->indices = indices;
-        this->textures = textures;
+        std::vector<MeshData> meshData(workList.size());
+        std::vector<MeshOptimizationStats> meshStats(options.optimizeMeshes ? workList.size() : 0);
+        auto convert = [&workList, &meshData, &meshStats, &options](size_t i) {
+            meshData[i] = convertMesh(workList[i]);
+            if (options.optimizeMeshes) {
+                meshStats[i] = MeshOptimizer::optimize(meshData[i]);
+            }
+            if (options.lodLevels > 0) {
+                MeshSimplifier::generateLods(meshData[i], options.lodLevels, options.lodTargetError);
+            }
+        };
 
-        setupMesh();
+        if (options.parallelMeshProcessing && workList.size() > 1) {
+            ThreadPool::shared().parallelFor(workList.size(), convert);
+        } else {
+            for (size_t i = 0; i < workList.size(); i++) {
+                convert(i);
+            }
+        }
+
+        if (optimizationStats) {
+            for (const MeshOptimizationStats& stats : meshStats) {
+                *optimizationStats += stats;
+            }
+        }
+        return meshData;
     }
 
-    void draw(const Shader& shader) {
-        unsigned int diffuseNr = 1;
-        unsigned int specularNr = 1;
-
-        for (unsigned int i = 0; i < textures.size(); i++) {
-            glActiveTexture(GL_TEXTURE0 + i);
-            std::string number;
-            std::string name = textures[i].type;
-            if (name == "diffuse") {
-                number = std::to_string(diffuseNr++);
-            } else if (name == "specular") {
-                number = std::to_string(specularNr++);
+    static MeshData convertMesh(const aiMesh* mesh) {
+        MeshData data;
+        data.vertices.resize(mesh->mNumVertices);
+
+        for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
+            Vertex& vertex = data.vertices[i];
+            // process vertex positions, normals, and texture coords
+            vertex.position = glm::vec3(
+                mesh->mVertices[i].x,
+                mesh->mVertices[i].y,
+                mesh->mVertices[i].z
+            );
+
+            vertex.normal = glm::vec3(
+                mesh->mNormals[i].x,
+                mesh->mNormals[i].y,
+                mesh->mNormals[i].z
+            );
+
+            if (mesh->mTextureCoords[0]) {
+                vertex.texCoords = glm::vec2(
+                    mesh->mTextureCoords[0][i].x,
+                    mesh->mTextureCoords[0][i].y
+                );
+            } else {
+                vertex.texCoords = glm::vec2(0.0f);
             }
+        }
 
-            shader.setInt(("material." + name).c_str(), i);
-            glBindTexture(GL_TEXTURE_2D, textures[i].id);
+        // process indices (faces are triangles after aiProcess_Triangulate)
+        data.indices.reserve(size_t(mesh->mNumFaces) * 3);
+        for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
+            const aiFace& face = mesh->mFaces[i];
+            data.indices.insert(data.indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
         }
 
-        glActiveTexture(GL_TEXTURE0);
-    
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+        return data;
+    }
+
+    /**
+     * Selects the level of detail of every mesh for the given model matrix and camera, see Mesh::selectLod.
+     * viewportHeight is in pixels. Call once per frame before draw/drawIndirect.
+     */
+    void updateLod(const glm::mat4& modelMatrix, const Camera& camera, float viewportHeight) {
+        float modelScale = maxScale(modelMatrix);
+        float pixelsPerUnitAtOne = viewportHeight / (2.0f * glm::tan(glm::radians(camera.getZoom()) * 0.5f));
+
+        for (Mesh& mesh : meshes) {
+            glm::vec3 center = glm::vec3(modelMatrix * glm::vec4(mesh.getBoundsCenter(), 1.0f));
+            // distance to the nearest point of the bounding sphere
+            float distance = glm::length(center - camera.getPosition()) - mesh.getBoundsRadius() * modelScale;
+            distance = std::max(distance, camera.getNearPlane());
+
+            unsigned int previousLevel = mesh.getLodLevel();
+            mesh.selectLod(pixelsPerUnitAtOne * modelScale / distance, options.lodPixelError, options.lodHysteresis);
+            if (mesh.getLodLevel() != previousLevel) {
+                indirectCommandsStale = true;
+            }
+        }
+    }
+
+    // pins every mesh to level (or its coarsest one), until the next updateLod
+    void setLodLevel(unsigned int level) {
+        for (Mesh& mesh : meshes) {
+            mesh.setLodLevel(level);
+        }
+        indirectCommandsStale = true;
+    }
+
+    // triangles the next draw submits with the currently selected levels of detail
+    size_t drawnTriangleCount() const {
+        size_t triangles = 0;
+        for (const Mesh& mesh : meshes) {
+            triangles += mesh.currentLod().indexCount / 3;
+        }
+        return triangles;
+    }
+
+    void draw(const Shader& shader) {
+        for (Mesh& mesh : meshes) {
+            mesh.draw(shader);
+        }
         glBindVertexArray(0);
     }
 
-private:
-    // render data
-    unsigned int VAO, VBO, EBO;
-
-    void setupMesh() {
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
-
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-    
-        // vertex position
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
-        // vertex normals
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
-        // vertex texture coords
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+    /**
+     * Draws only the meshes whose bounding sphere, placed by modelMatrix, intersects frustum.
+     * The spheres are tested in one FrustumCulling batch. Returns the number of meshes drawn.
+     */
+    size_t draw(const Shader& shader, const Frustum& frustum, const glm::mat4& modelMatrix) {
+        float modelScale = maxScale(modelMatrix);
+        cullingSpheres.clear();
+        for (const Mesh& mesh : meshes) {
+            glm::vec3 center = glm::vec3(modelMatrix * glm::vec4(mesh.getBoundsCenter(), 1.0f));
+            cullingSpheres.add(center, mesh.getBoundsRadius() * modelScale);
+        }
+        FrustumCulling::cullSpheres(frustum, cullingSpheres, cullingVisibility);
 
+        size_t drawn = 0;
+        for (size_t i = 0; i < meshes.size(); i++) {
+            if (cullingVisibility.visible(i)) {
+                meshes[i].draw(shader);
+                drawn++;
+            }
+        }
         glBindVertexArray(0);
+        return drawn;
     }
 
-};
+    // texture units per batch for each of the diffuse and specular sampler arrays of indirect_lighting_fragment.glsl
+    static constexpr unsigned int indirectBatchTextures = 8;
 
-class Model {
-public:
-    Model(char* path) {
-        loadModel(path);
+    // true if drawIndirect can be used, otherwise draw has to be
+    bool canDrawIndirect() const {
+        return options.vertexFormat == VertexFormat::Float32 && GLExtensions::supportsIndirectDraw();
     }
 
-    void draw(const Shader& shader) {
-        for (Mesh m : meshes) {
-            m.draw(shader);
+    /**
+     * Draws every mesh with one glMultiDrawElementsIndirect per batch of up to indirectBatchTextures
+     * diffuse and specular maps, instead of a bind/setInt/draw sequence per mesh.
+     * The command and per draw material buffers are built on the first call and
+     * rebuilt only when the geometry arena has moved the meshes or a mesh changed its level of detail since.
+     * shader must be built from indirect_vertex.glsl and indirect_lighting_fragment.glsl.
+     * @precondition canDrawIndirect()
+     */
+    void drawIndirect(const Shader& shader) {
+        GeometryArena<Vertex>& arena = GeometryArena<Vertex>::shared();
+        if (!indirectCommandBuffer || indirectCommandsStale || indirectArenaRelocations != arena.relocationCount()) {
+            buildIndirectCommands();
+        }
+
+        arena.bind();
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectCommandBuffer.get());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, drawMaterialBuffer.get());
+
+        for (const IndirectBatch& batch : indirectBatches) {
+            if (batch.commandCount == 0) {
+                continue;
+            }
+            for (unsigned int i = 0; i < batch.diffuseMaps.size(); i++) {
+                glActiveTexture(GL_TEXTURE0 + i);
+                glBindTexture(GL_TEXTURE_2D, batch.diffuseMaps[i]);
+            }
+            for (unsigned int i = 0; i < batch.specularMaps.size(); i++) {
+                glActiveTexture(GL_TEXTURE0 + indirectBatchTextures + i);
+                glBindTexture(GL_TEXTURE_2D, batch.specularMaps[i]);
+            }
+
+            shader.setInt("firstDraw"_u, batch.firstCommand);
+            GLExtensions::features().multiDrawElementsIndirect(
+                GL_TRIANGLES, GL_UNSIGNED_INT,
+                reinterpret_cast<const void*>(size_t(batch.firstCommand) * sizeof(DrawElementsIndirectCommand)),
+                batch.commandCount, 0
+            );
         }
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        glBindVertexArray(0);
     }
 
 private:
     std::vector<Mesh> meshes;
     std::string directory;
-    std::vector<Texture> loaded_textures;
+    ModelLoadOptions options;
+    bool fromCache = false;
+    MeshOptimizationStats optimizationStats;
+
+    // meshes drawn by one glMultiDrawElementsIndirect call, with the textures their draws index into
+    struct IndirectBatch {
+        std::vector<unsigned int> diffuseMaps;
+        std::vector<unsigned int> specularMaps;
+        int firstCommand = 0;
+        GLsizei commandCount = 0;
+    };
+
+    GLBuffer indirectCommandBuffer;
+    // per draw ivec2(diffuse slot, specular slot), -1 if the mesh has no such map
+    GLBuffer drawMaterialBuffer;
+    std::vector<IndirectBatch> indirectBatches;
+    unsigned int indirectArenaRelocations = 0;
+    bool indirectCommandsStale = false;
+    static constexpr int batchFull = -2;
+
+    // world space bounds of the meshes and their frustum test, kept to reuse the allocations every frame
+    SphereBatch cullingSpheres;
+    VisibilityMask cullingVisibility;
+
+    // largest axis scale of a model matrix, what a bounding radius has to be scaled by
+    static float maxScale(const glm::mat4& modelMatrix) {
+        return std::max({
+            glm::length(glm::vec3(modelMatrix[0])),
+            glm::length(glm::vec3(modelMatrix[1])),
+            glm::length(glm::vec3(modelMatrix[2]))
+        });
+    }
+
+    static constexpr unsigned int importerOptions =
+        aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals;
+
+    // post import steps that change the cached mesh data
+    uint32_t processFlags() const {
+        uint32_t flags = 0;
+        if (options.optimizeMeshes) {
+            flags |= MeshCache::processOptimized;
+        }
+        if (options.lodLevels > 0) {
+            flags |= MeshCache::processLods;
+        }
+        return flags;
+    }
 
     void loadModel(std::string path) {
+        directory = path.substr(0, path.find_last_of('/'));
+
+        MeshCacheKey cacheKey;
+        bool haveCacheKey = options.useMeshCache && MeshCache::makeKey(path, importerOptions, processFlags(), cacheKey);
+        if (options.lodLevels > 0) {
+            cacheKey.lodLevels = options.lodLevels;
+            cacheKey.lodTargetError = options.lodTargetError;
+        }
+        std::string cachePath = MeshCache::cachePathFor(path);
+
+        if (haveCacheKey && loadFromCache(cachePath, cacheKey)) {
+            fromCache = true;
+            return;
+        }
+
         Assimp::Importer importer;        
 
-        auto importerOptions = (aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals);
         const aiScene* scene = importer.ReadFile(path, importerOptions);
 
         if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
@@ -128,66 +356,140 @@ private:
             return;
         }
 
-        directory = path.substr(0, path.find_last_of('/'));
+        processScene(scene);
 
-        processNode(scene->mRootNode, scene);
-    }
+        if (haveCacheKey && !MeshCache::write(cachePath, cacheKey, meshes)) {
+            std::cout << "WARNING::MESH_CACHE::Failed to write cache file: " << cachePath << std::endl;
+        }
 
-    void processNode(aiNode* node, const aiScene* scene) {
-        // process all the node's meshes (if any)
-        for(unsigned int i = 0; i < node->mNumMeshes; i++)
-        {
-            aiMesh *mesh = scene->mMeshes[node->mMeshes[i]]; 
-            meshes.push_back(processMesh(mesh, scene));			
+        // the cache is written from the CPU copies, so they can only go after it
+        if (!options.keepCpuData) {
+            for (Mesh& mesh : meshes) {
+                mesh.releaseCpuData();
+            }
         }
-        // then do the same for each of its children
-        for(unsigned int i = 0; i < node->mNumChildren; i++)
-        {
-            processNode(node->mChildren[i], scene);
+    }
+
+    bool loadFromCache(const std::string& cachePath, const MeshCacheKey& cacheKey) {
+        MeshCache cache;
+        if (!cache.open(cachePath, cacheKey)) {
+            return false;
         }
-    }  
 
-    Mesh processMesh(aiMesh* mesh, const aiScene* scene) {
-        std::vector<Vertex> vertices;
-        std::vector<unsigned int> indices;
-        std::vector<Texture> textures;
+        meshes.reserve(cache.meshes().size());
+        for (const CachedMesh& cachedMesh : cache.meshes()) {
+            std::vector<Texture> textures;
+            for (const CachedTextureRef& textureRef : cachedMesh.textures) {
+                textures.push_back(loadTexture(textureRef.path.c_str(), textureRef.type));
+            }
 
-        for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
-            Vertex vertex;
-            // process vertex positions, normals, and texture coords
-            vertex.position = glm::vec3(
-                mesh->mVertices[i].x,
-                mesh->mVertices[i].y,
-                mesh->mVertices[i].z
+            // upload straight from the mapping
+            meshes.emplace_back(
+                cachedMesh.vertices, cachedMesh.vertexCount,
+                cachedMesh.indices, cachedMesh.indexCount,
+                std::move(textures), options.vertexFormat, cachedMesh.lods, options.keepCpuData
             );
+        }
+        return true;
+    }
 
-            vertex.normal = glm::vec3(
-                mesh->mNormals[i].x,
-                mesh->mNormals[i].y,
-                mesh->mNormals[i].z
+    void processScene(const aiScene* scene) {
+        std::vector<const aiMesh*> workList;
+        collectMeshes(scene->mRootNode, scene, workList);
+
+        std::vector<MeshData> meshData = convertMeshes(workList, options, &optimizationStats);
+
+        // textures and GL buffers have to be created on the context thread
+        meshes.reserve(workList.size());
+        for (size_t i = 0; i < workList.size(); i++) {
+            meshes.emplace_back(
+                std::move(meshData[i].vertices),
+                std::move(meshData[i].indices),
+                loadMeshTextures(workList[i], scene),
+                options.vertexFormat,
+                std::move(meshData[i].lods)
             );
+        }
+    }
 
-            if (mesh->mTextureCoords[0]) {
-                vertex.texCoords = glm::vec2(
-                    mesh->mTextureCoords[0][i].x,
-                    mesh->mTextureCoords[0][i].y
-                );
-            } else {
-                vertex.texCoords = glm::vec2(0.0f);
+    void buildIndirectCommands() {
+        std::vector<DrawElementsIndirectCommand> commands;
+        std::vector<int32_t> drawMaterials;
+        indirectBatches.clear();
+        indirectBatches.emplace_back();
+
+        for (const Mesh& mesh : meshes) {
+            GeometryRange range = mesh.geometryRange();
+            if (range.indexCount == 0) {
+                continue;
+            }
+
+            unsigned int diffuseMap = 0;
+            unsigned int specularMap = 0;
+            for (const Texture& texture : mesh.textures) {
+                if (texture.type == "texture_diffuse" && diffuseMap == 0) {
+                    diffuseMap = texture.handle->id;
+                } else if (texture.type == "texture_specular" && specularMap == 0) {
+                    specularMap = texture.handle->id;
+                }
+            }
+
+            int diffuseSlot = textureSlot(indirectBatches.back().diffuseMaps, diffuseMap);
+            int specularSlot = textureSlot(indirectBatches.back().specularMaps, specularMap);
+            if (diffuseSlot == batchFull || specularSlot == batchFull) {
+                // out of texture units, start a new batch
+                IndirectBatch batch;
+                batch.firstCommand = static_cast<int>(commands.size());
+                indirectBatches.push_back(batch);
+                diffuseSlot = textureSlot(indirectBatches.back().diffuseMaps, diffuseMap);
+                specularSlot = textureSlot(indirectBatches.back().specularMaps, specularMap);
             }
 
-            vertices.push_back(vertex);
+            const MeshLod& lod = mesh.currentLod();
+            commands.push_back({lod.indexCount, 1, range.firstIndex + lod.firstIndex, range.baseVertex, 0});
+            drawMaterials.push_back(diffuseSlot);
+            drawMaterials.push_back(specularSlot);
+            indirectBatches.back().commandCount++;
         }
 
-        // process indices
-        for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
-            aiFace face = mesh->mFaces[i];
-            for (unsigned int j = 0; j < face.mNumIndices; j++) {
-                indices.push_back(face.mIndices[j]);
+        if (!indirectCommandBuffer) {
+            indirectCommandBuffer = GLBuffer::create();
+            drawMaterialBuffer = GLBuffer::create();
+        }
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectCommandBuffer.get());
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawMaterialBuffer.get());
+        glBufferData(GL_SHADER_STORAGE_BUFFER, drawMaterials.size() * sizeof(int32_t), drawMaterials.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        indirectArenaRelocations = GeometryArena<Vertex>::shared().relocationCount();
+        indirectCommandsStale = false;
+    }
+
+    /**
+     * Slot of texture in a batch's sampler array, adding it if there is room.
+     * Returns -1 for no texture and batchFull if the array has no room left.
+     */
+    static int textureSlot(std::vector<unsigned int>& slots, unsigned int texture) {
+        if (texture == 0) {
+            return -1;
+        }
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (slots[i] == texture) {
+                return static_cast<int>(i);
             }
         }
+        if (slots.size() == indirectBatchTextures) {
+            return batchFull;
+        }
+        slots.push_back(texture);
+        return static_cast<int>(slots.size() - 1);
+    }
+
+    std::vector<Texture> loadMeshTextures(const aiMesh* mesh, const aiScene* scene) {
+        std::vector<Texture> textures;
 
-        // process material
         if (mesh->mMaterialIndex >= 0) {
             aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
             
@@ -202,7 +504,7 @@ private:
             textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
         }
 
-        return Mesh(vertices, indices, textures);
+        return textures;
     }
 
     std::vector<Texture> loadMaterialTextures(
@@ -212,63 +514,20 @@ private:
         for(unsigned int i = 0; i < mat->GetTextureCount(type); i++) {
             aiString str;
             mat->GetTexture(type, i, &str);
-            
-            bool skip = false;
-            
-            for (auto loaded_texture : loaded_textures) {
-                if (std::strcmp(loaded_texture.path.data(), str.C_Str()) == 0) {
-                    textures.push_back(loaded_texture);
-                    skip = true;
-                    break;
-                }
-            }
-
-            if (!skip) {
-                Texture texture;
-                texture.id = TextureFromFile(str.C_Str(), directory);
-                texture.type = typeName;
-                texture.path = std::string(str.C_Str());
-                textures.push_back(texture);
-                loaded_textures.push_back(texture);
-            }
+            textures.push_back(loadTexture(str.C_Str(), typeName));
         }
 
         return textures;
     }
 
-    unsigned int TextureFromFile(const char* path, const std::string& directory) {
-        std::string filename = std::string(path);
-        filename = directory + '/' + filename;
-
-        unsigned int textureID;
-        glGenTextures(1, &textureID);
-
-        int width, height, nrComponents;
-        unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-        if (data) {
-            GLenum format;
-            if (nrComponents == 1)
-                format = GL_RED;
-            else if (nrComponents == 3)
-                format = GL_RGB;
-            else if (nrComponents == 4)
-                format = GL_RGBA;
-
-            glBindTexture(GL_TEXTURE_2D, textureID);
-            glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-            stbi_image_free(data);
-        } else {
-            std::cout << "Texture failed to load at path: " << path << std::endl;
-            stbi_image_free(data);
-        }
-
-        return textureID;
+    Texture loadTexture(const char* path, const std::string& typeName) {
+        Texture texture;
+        // shared with every other model, decoded once per image
+        texture.handle = TextureRegistry::shared().load2D(
+            directory + '/' + path, options.flipTexturesVertically
+        );
+        texture.type = typeName;
+        texture.path = std::string(path);
+        return texture;
     }
 };
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "gl_extensions.h"
+#include "mapped_file.h"
+
+/**
+ * Identifies a linked program: the sources it was built from and the driver that built it.
+ * A binary is only valid for the exact driver, so vendor, renderer and version are part of the key.
+ */
+struct ProgramCacheKey {
+    uint64_t sourceHash = 0;
+    std::string driver;
+};
+
+/**
+ * Opt-in on-disk cache of linked program binaries (glGetProgramBinary / glProgramBinary).
+ *
+ * File layout (native endianness): FileHeader | driver string | binary.
+ * Files are named after the hash of the key and validated against the full key and a payload hash,
+ * so a stale, truncated or corrupt file is treated as a miss. A binary the driver refuses to link
+ * is deleted and the program is compiled from source again. Context thread only.
+ */
+class ProgramCache {
+public:
+    static constexpr uint32_t version = 1;
+
+    static ProgramCache& shared() {
+        static ProgramCache cache;
+        return cache;
+    }
+
+    ProgramCache(const ProgramCache&) = delete;
+    ProgramCache& operator=(const ProgramCache&) = delete;
+
+    /**
+     * Turns caching on, binaries are kept in directory (created if missing).
+     * Returns false and stays disabled if the driver can't retrieve program binaries or the directory can't be created.
+     * @precondition GLExtensions::load has run
+     */
+    bool enable(const std::string& directory) {
+        enabled_ = false;
+        if (!GLExtensions::features().programBinary) {
+            return false;
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (error) {
+            std::cout << "WARNING::PROGRAM_CACHE::Failed to create cache directory: " << directory << std::endl;
+            return false;
+        }
+
+        directory_ = directory;
+        enabled_ = true;
+        return true;
+    }
+
+    void disable() {
+        enabled_ = false;
+    }
+
+    bool enabled() const {
+        return enabled_;
+    }
+
+    const std::string& directory() const {
+        return directory_;
+    }
+
+    /**
+     * Key for a program built from the given sources by the current driver.
+     */
+    ProgramCacheKey makeKey(const std::string& vertexSource, const std::string& fragmentSource) {
+        if (driver_.empty()) {
+            driver_ = glString(GL_VENDOR) + "\n" + glString(GL_RENDERER) + "\n" + glString(GL_VERSION);
+        }
+
+        ProgramCacheKey key;
+        // the length keeps "ab" + "c" and "a" + "bc" apart
+        uint64_t vertexLength = vertexSource.size();
+        key.sourceHash = hash(&vertexLength, sizeof(vertexLength));
+        key.sourceHash = hash(vertexSource.data(), vertexSource.size(), key.sourceHash);
+        key.sourceHash = hash(fragmentSource.data(), fragmentSource.size(), key.sourceHash);
+        key.driver = driver_;
+        return key;
+    }
+
+    std::string pathFor(const ProgramCacheKey& key) const {
+        uint64_t fileHash = hash(key.driver.data(), key.driver.size(), key.sourceHash);
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.progbin", static_cast<unsigned long long>(fileHash));
+        return (std::filesystem::path(directory_) / name).string();
+    }
+
+    /**
+     * Links program from a cached binary. Returns false on a miss, an invalid file or a binary the driver rejects,
+     * program then has to be built from source (glProgramBinary leaves it unlinked, it can still be used for that).
+     */
+    bool load(const ProgramCacheKey& key, GLuint program) {
+        std::string path = pathFor(key);
+        MappedFile file;
+        if (!file.open(path)) {
+            misses_++;
+            return false;
+        }
+
+        const unsigned char* binary = nullptr;
+        FileHeader header;
+        if (!parse(file, key, header, binary)) {
+            file.close();
+            std::remove(path.c_str());
+            misses_++;
+            return false;
+        }
+
+        GLExtensions::features().programBinaryLoad(program, header.binaryFormat, binary, static_cast<GLsizei>(header.binaryLength));
+        file.close();
+
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            // e.g. a driver update that kept the version string
+            std::remove(path.c_str());
+            rejected_++;
+            return false;
+        }
+
+        hits_++;
+        return true;
+    }
+
+    /**
+     * Retrieves the binary of a linked program and writes it for key. The program should have been
+     * linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set. Written to a temporary file and renamed,
+     * so a concurrent reader never sees a partial file.
+     */
+    bool store(const ProgramCacheKey& key, GLuint program) {
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) {
+            return false;
+        }
+
+        std::vector<unsigned char> binary(length);
+        GLsizei written = 0;
+        GLenum format = 0;
+        GLExtensions::features().getProgramBinary(program, length, &written, &format, binary.data());
+        if (written <= 0) {
+            return false;
+        }
+        binary.resize(written);
+
+        FileHeader header{};
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version = version;
+        header.binaryFormat = format;
+        header.binaryLength = static_cast<uint32_t>(binary.size());
+        header.driverLength = static_cast<uint32_t>(key.driver.size());
+        header.sourceHash = key.sourceHash;
+        header.binaryHash = hash(binary.data(), binary.size());
+
+        std::string path = pathFor(key);
+        std::string tempPath = path + ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(key.driver.data(), key.driver.size());
+            out.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+            if (!out) {
+                out.close();
+                std::remove(tempPath.c_str());
+                return false;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempPath, path, error);
+        if (error) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // programs linked from the cache, lookups without a usable file, and binaries the driver refused
+    size_t hitCount() const {
+        return hits_;
+    }
+
+    size_t missCount() const {
+        return misses_;
+    }
+
+    size_t rejectedCount() const {
+        return rejected_;
+    }
+
+    // 64 bit FNV-1a, continued from seed
+    static uint64_t hash(const void* data, size_t bytes, uint64_t seed = 14695981039346656037ull) {
+        const unsigned char* bytesIn = static_cast<const unsigned char*>(data);
+        uint64_t value = seed;
+        for (size_t i = 0; i < bytes; i++) {
+            value ^= bytesIn[i];
+            value *= 1099511628211ull;
+        }
+        return value;
+    }
+
+private:
+    static constexpr char magic[4] = {'P', 'R', 'G', 'B'};
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t binaryFormat;
+        uint32_t binaryLength;
+        uint32_t driverLength;
+        uint32_t reserved;
+        uint64_t sourceHash;
+        uint64_t binaryHash;
+    };
+
+    bool enabled_ = false;
+    std::string directory_;
+    std::string driver_;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+    size_t rejected_ = 0;
+
+    ProgramCache() = default;
+
+    static std::string glString(GLenum name) {
+        const GLubyte* value = glGetString(name);
+        return value ? reinterpret_cast<const char*>(value) : "";
+    }
+
+    static bool parse(const MappedFile& file, const ProgramCacheKey& key, FileHeader& header, const unsigned char*& binary) {
+        if (file.size() < sizeof(FileHeader)) {
+            return false;
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, magic, sizeof(magic)) != 0
+            || header.version != version
+            || header.sourceHash != key.sourceHash
+            || header.driverLength != key.driver.size()) {
+            return false;
+        }
+
+        // the sizes must account for the whole file, so a truncated or padded file is rejected
+        uint64_t expectedSize = uint64_t(sizeof(FileHeader)) + header.driverLength + header.binaryLength;
+        if (header.binaryLength == 0 || expectedSize != file.size()) {
+            return false;
+        }
+
+        const unsigned char* driver = file.data() + sizeof(FileHeader);
+        if (std::memcmp(driver, key.driver.data(), header.driverLength) != 0) {
+            return false;
+        }
+
+        binary = driver + header.driverLength;
+        return hash(binary, header.binaryLength) == header.binaryHash;
+    }
+};
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+/**
+ * Moves a live allocation to a lower offset, produced by RangeAllocator::compact.
+ */
+struct RangeMove {
+    uint32_t from;
+    uint32_t to;
+    uint32_t size;
+};
+
+/**
+ * Sub-allocates ranges of a linear space of capacity units (bytes, vertices, indices, ...).
+ *
+ * Free blocks are kept both by offset (to coalesce neighbours on free) and by size (best fit allocation).
+ * Pure CPU bookkeeping, the owner of the actual storage applies growth and compaction moves to it.
+ */
+class RangeAllocator {
+public:
+    explicit RangeAllocator(uint32_t capacity = 0) {
+        grow(capacity);
+    }
+
+    /**
+     * Finds the smallest free block that fits size, returns false if there is none.
+     * @precondition size > 0
+     */
+    bool allocate(uint32_t size, uint32_t& offset) {
+        auto best = freeBySize_.lower_bound(size);
+        if (best == freeBySize_.end()) {
+            return false;
+        }
+
+        uint32_t blockSize = best->first;
+        offset = best->second;
+        freeBySize_.erase(best);
+        freeByOffset_.erase(offset);
+
+        if (blockSize > size) {
+            insertFree(offset + size, blockSize - size);
+        }
+
+        allocated_[offset] = size;
+        used_ += size;
+        return true;
+    }
+
+    /**
+     * Returns the allocation starting at offset to the free list, merging it with adjacent free blocks.
+     * @precondition offset was returned by allocate and not freed since
+     */
+    void free(uint32_t offset) {
+        auto allocation = allocated_.find(offset);
+        if (allocation == allocated_.end()) {
+            return;
+        }
+
+        uint32_t size = allocation->second;
+        allocated_.erase(allocation);
+        used_ -= size;
+
+        // merge with the following block
+        auto next = freeByOffset_.find(offset + size);
+        if (next != freeByOffset_.end()) {
+            size += next->second;
+            eraseFree(next);
+        }
+
+        // merge with the preceding block
+        auto previous = freeByOffset_.lower_bound(offset);
+        if (previous != freeByOffset_.begin()) {
+            --previous;
+            if (previous->first + previous->second == offset) {
+                offset = previous->first;
+                size += previous->second;
+                eraseFree(previous);
+            }
+        }
+
+        insertFree(offset, size);
+    }
+
+    /**
+     * Extends the space to newCapacity, the added units become free. Shrinking is ignored.
+     */
+    void grow(uint32_t newCapacity) {
+        if (newCapacity <= capacity_) {
+            return;
+        }
+
+        uint32_t oldCapacity = capacity_;
+        capacity_ = newCapacity;
+
+        // the new tail is allocated and freed so it coalesces with a trailing free block
+        allocated_[oldCapacity] = newCapacity - oldCapacity;
+        used_ += newCapacity - oldCapacity;
+        free(oldCapacity);
+    }
+
+    /**
+     * Slides every allocation down to close all gaps, leaving a single free block at the end.
+     * Returns the moves in ascending offset order, an allocation at m.from now lives at m.to.
+     * Applying them in order never overwrites data that is yet to be moved,
+     * but a move's source and destination may overlap.
+     */
+    std::vector<RangeMove> compact() {
+        std::vector<RangeMove> moves;
+        std::map<uint32_t, uint32_t> compacted;
+
+        uint32_t next = 0;
+        for (const auto& allocation : allocated_) {
+            if (allocation.first != next) {
+                moves.push_back({allocation.first, next, allocation.second});
+            }
+            compacted[next] = allocation.second;
+            next += allocation.second;
+        }
+
+        allocated_.swap(compacted);
+        freeByOffset_.clear();
+        freeBySize_.clear();
+        if (next < capacity_) {
+            insertFree(next, capacity_ - next);
+        }
+        return moves;
+    }
+
+    uint32_t capacity() const {
+        return capacity_;
+    }
+
+    uint32_t usedSize() const {
+        return used_;
+    }
+
+    uint32_t freeSize() const {
+        return capacity_ - used_;
+    }
+
+    uint32_t allocationCount() const {
+        return static_cast<uint32_t>(allocated_.size());
+    }
+
+    uint32_t freeBlockCount() const {
+        return static_cast<uint32_t>(freeByOffset_.size());
+    }
+
+    uint32_t largestFreeBlock() const {
+        return freeBySize_.empty() ? 0 : freeBySize_.rbegin()->first;
+    }
+
+    // used share of the capacity, in [0, 1]
+    float occupancy() const {
+        return capacity_ == 0 ? 0.0f : float(used_) / float(capacity_);
+    }
+
+    // share of the free space outside the largest free block, 0 when all free space is contiguous
+    float fragmentation() const {
+        uint32_t freeUnits = freeSize();
+        return freeUnits == 0 ? 0.0f : 1.0f - float(largestFreeBlock()) / float(freeUnits);
+    }
+
+private:
+    uint32_t capacity_ = 0;
+    uint32_t used_ = 0;
+    // offset -> size
+    std::map<uint32_t, uint32_t> allocated_;
+    std::map<uint32_t, uint32_t> freeByOffset_;
+    // size -> offset
+    std::multimap<uint32_t, uint32_t> freeBySize_;
+
+    void insertFree(uint32_t offset, uint32_t size) {
+        freeByOffset_[offset] = size;
+        freeBySize_.emplace(size, offset);
+    }
+
+    void eraseFree(std::map<uint32_t, uint32_t>::iterator block) {
+        auto sizes = freeBySize_.equal_range(block->second);
+        for (auto it = sizes.first; it != sizes.second; ++it) {
+            if (it->second == block->first) {
+                freeBySize_.erase(it);
+                break;
+            }
+        }
+        freeByOffset_.erase(block);
+    }
+};
@@ -4,75 +4,94 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
-#include <fstream>
-#include <sstream>
+#include <string_view>
+#include <utility>
 #include <iostream>
-#include <string>
+#include <vector>
+
+#include "gl_extensions.h"
+#include "program_cache.h"
+#include "shader_preprocessor.h"
+#include "shader_watcher.h"
+#include "uniform_shadow.h"
+#include "uniform_table.h"
+
+// location of a uniform, looked up once instead of by name on every set
+struct UniformHandle
+{
+    GLint location = -1;
+};
 
 class Shader {
 public:
-    unsigned int ID;
-    // constructor generates the shader on the fly
+    unsigned int ID = 0;
+    // constructor generates the shader on the fly, waiting for the compile and link to finish
     // ------------------------------------------------------------------------
-    Shader(const std::string& vertexFileName, const std::string& fragmentFileName)
+    Shader(const std::string& vertexFileName, const std::string& fragmentFileName, const ShaderDefines& defines = ShaderDefines())
+        : Shader(vertexFileName, fragmentFileName, defines, Deferred{})
     {
-        std::string shaderDir = "resources/shaders/";
-        std::string vertexPath = shaderDir + vertexFileName;
-        std::string fragmentPath = shaderDir + fragmentFileName;
-
-        // 1. retrieve the vertex/fragment source code from filePath
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        try 
-        {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();		
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();			
-        }
-        catch (std::ifstream::failure& e)
+        wait();
+    }
+    // submits the compiles and the link without waiting for them, so several programs build in parallel
+    // (KHR_parallel_shader_compile) while other loading goes on. isReady polls the build, wait blocks on it.
+    // ------------------------------------------------------------------------
+    static Shader submit(const std::string& vertexFileName, const std::string& fragmentFileName, const ShaderDefines& defines = ShaderDefines())
+    {
+        return Shader(vertexFileName, fragmentFileName, defines, Deferred{});
+    }
+    // the program and any shaders still building are owned, so a shader can only be moved
+    // ------------------------------------------------------------------------
+    ~Shader()
+    {
+        release();
+    }
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+    Shader(Shader&& other) noexcept
+    {
+        takeFrom(other);
+    }
+    Shader& operator=(Shader&& other) noexcept
+    {
+        if (this != &other)
         {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
+            release();
+            takeFrom(other);
         }
-        const char* vShaderCode = vertexCode.c_str();
-        const char * fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
-        unsigned int vertex, fragment;
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX - " + vertexFileName);
-        // fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT - " + fragmentFileName);
-        // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-        // delete the shaders as they're linked into our program now and no longer necessary
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-
+        return *this;
+    }
+    // true once the program has linked. Doesn't block where parallel compilation is supported,
+    // elsewhere the first call waits for the build. A program that failed to build isn't ready until it is rebuilt.
+    // While the ShaderWatcher is active this is also where the program is rebuilt from changed files, see pollReload
+    // ------------------------------------------------------------------------
+    bool isReady()
+    {
+        if (!pollBuild())
+            return false;
+        if (ShaderWatcher::shared().active())
+            pollReload();
+        return linked;
+    }
+    // blocks until the build has finished, returns whether the program linked
+    // ------------------------------------------------------------------------
+    bool wait()
+    {
+        if (!built)
+            finishBuild();
+        return linked;
+    }
+    // runs configure (block bindings, sampler units, uniform handles) once the program has linked,
+    // right away if it already has, and again every time it is relinked by a reload
+    // ------------------------------------------------------------------------
+    void onReady(std::function<void(Shader&)> configure)
+    {
+        readyCallback = std::move(configure);
+        if (built && linked)
+            readyCallback(*this);
     }
     // activate the shader
     // ------------------------------------------------------------------------
@@ -80,66 +99,450 @@ public:
     { 
         glUseProgram(ID); 
     }
-    // utility uniform functions
+    // attaches the program's uniform block blockName to a binding point, false if the program has no such active block
+    // ------------------------------------------------------------------------
+    bool bindUniformBlock(const char* blockName, GLuint binding) const
+    {
+        GLuint index = glGetUniformBlockIndex(ID, blockName);
+        if (index == GL_INVALID_INDEX)
+            return false;
+        glUniformBlockBinding(ID, index, binding);
+        return true;
+    }
+    // uniform lookup, resolved from the table built at link time without calling into GL
     // ------------------------------------------------------------------------
-    void setBool(const std::string &name, bool value) const
+    UniformHandle uniform(std::string_view name) const
+    {
+        return UniformHandle{uniforms.find(name)};
+    }
+    UniformHandle uniform(UniformId id) const
+    {
+        return UniformHandle{uniforms.find(id)};
+    }
+    // utility uniform functions, by name, hashed id or handle. A value the program already holds isn't uploaded again
+    // ------------------------------------------------------------------------
+    void setBool(std::string_view name, bool value) const
     {         
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+        setBool(uniform(name), value);
+    }
+    void setBool(UniformId id, bool value) const
+    {
+        setBool(uniform(id), value);
+    }
+    void setBool(UniformHandle handle, bool value) const
+    {
+        int stored = value;
+        if (changed(handle, &stored, sizeof(stored)))
+            glUniform1i(handle.location, stored);
     }
     // ------------------------------------------------------------------------
-    void setInt(const std::string &name, int value) const
+    void setInt(std::string_view name, int value) const
     { 
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+        setInt(uniform(name), value);
+    }
+    void setInt(UniformId id, int value) const
+    {
+        setInt(uniform(id), value);
+    }
+    void setInt(UniformHandle handle, int value) const
+    {
+        if (changed(handle, &value, sizeof(value)))
+            glUniform1i(handle.location, value);
     }
     // ------------------------------------------------------------------------
-    void setFloat(const std::string &name, float value) const
+    void setFloat(std::string_view name, float value) const
     { 
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+        setFloat(uniform(name), value);
+    }
+    void setFloat(UniformId id, float value) const
+    {
+        setFloat(uniform(id), value);
+    }
+    void setFloat(UniformHandle handle, float value) const
+    {
+        if (changed(handle, &value, sizeof(value)))
+            glUniform1f(handle.location, value);
     }
     // ------------------------------------------------------------------------
-    void setVec2(const std::string &name, const glm::vec2 &value) const
+    void setVec2(std::string_view name, const glm::vec2 &value) const
     { 
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+        setVec2(uniform(name), value);
     }
-    void setVec2(const std::string &name, float x, float y) const
+    void setVec2(UniformId id, const glm::vec2 &value) const
+    {
+        setVec2(uniform(id), value);
+    }
+    void setVec2(UniformHandle handle, const glm::vec2 &value) const
+    {
+        if (changed(handle, &value[0], sizeof(value)))
+            glUniform2fv(handle.location, 1, &value[0]);
+    }
+    void setVec2(std::string_view name, float x, float y) const
     { 
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y); 
+        setVec2(uniform(name), glm::vec2(x, y));
+    }
+    void setVec2(UniformId id, float x, float y) const
+    {
+        setVec2(uniform(id), glm::vec2(x, y));
     }
     // ------------------------------------------------------------------------
-    void setVec3(const std::string &name, const glm::vec3 &value) const
+    void setVec3(std::string_view name, const glm::vec3 &value) const
     { 
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+        setVec3(uniform(name), value);
+    }
+    void setVec3(UniformId id, const glm::vec3 &value) const
+    {
+        setVec3(uniform(id), value);
     }
-    void setVec3(const std::string &name, float x, float y, float z) const
+    void setVec3(UniformHandle handle, const glm::vec3 &value) const
+    {
+        if (changed(handle, &value[0], sizeof(value)))
+            glUniform3fv(handle.location, 1, &value[0]);
+    }
+    void setVec3(std::string_view name, float x, float y, float z) const
     { 
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z); 
+        setVec3(uniform(name), glm::vec3(x, y, z));
+    }
+    void setVec3(UniformId id, float x, float y, float z) const
+    {
+        setVec3(uniform(id), glm::vec3(x, y, z));
     }
     // ------------------------------------------------------------------------
-    void setVec4(const std::string &name, const glm::vec4 &value) const
+    void setVec4(std::string_view name, const glm::vec4 &value) const
     { 
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+        setVec4(uniform(name), value);
     }
-    void setVec4(const std::string &name, float x, float y, float z, float w) const
+    void setVec4(UniformId id, const glm::vec4 &value) const
+    {
+        setVec4(uniform(id), value);
+    }
+    void setVec4(UniformHandle handle, const glm::vec4 &value) const
+    {
+        if (changed(handle, &value[0], sizeof(value)))
+            glUniform4fv(handle.location, 1, &value[0]);
+    }
+    void setVec4(std::string_view name, float x, float y, float z, float w) const
     { 
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w); 
+        setVec4(uniform(name), glm::vec4(x, y, z, w));
+    }
+    void setVec4(UniformId id, float x, float y, float z, float w) const
+    {
+        setVec4(uniform(id), glm::vec4(x, y, z, w));
+    }
+    // ------------------------------------------------------------------------
+    void setMat2(std::string_view name, const glm::mat2 &mat) const
+    {
+        setMat2(uniform(name), mat);
+    }
+    void setMat2(UniformId id, const glm::mat2 &mat) const
+    {
+        setMat2(uniform(id), mat);
+    }
+    void setMat2(UniformHandle handle, const glm::mat2 &mat) const
+    {
+        if (changed(handle, &mat[0][0], sizeof(mat)))
+            glUniformMatrix2fv(handle.location, 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
-    void setMat2(const std::string &name, const glm::mat2 &mat) const
+    void setMat3(std::string_view name, const glm::mat3 &mat) const
+    {
+        setMat3(uniform(name), mat);
+    }
+    void setMat3(UniformId id, const glm::mat3 &mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat3(uniform(id), mat);
+    }
+    void setMat3(UniformHandle handle, const glm::mat3 &mat) const
+    {
+        if (changed(handle, &mat[0][0], sizeof(mat)))
+            glUniformMatrix3fv(handle.location, 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
-    void setMat3(const std::string &name, const glm::mat3 &mat) const
+    void setMat4(std::string_view name, const glm::mat4 &mat) const
+    {
+        setMat4(uniform(name), mat);
+    }
+    void setMat4(UniformId id, const glm::mat4 &mat) const
+    {
+        setMat4(uniform(id), mat);
+    }
+    void setMat4(UniformHandle handle, const glm::mat4 &mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        if (changed(handle, &mat[0][0], sizeof(mat)))
+            glUniformMatrix4fv(handle.location, 1, GL_FALSE, &mat[0][0]);
     }
+    // uniform updates of every program since the last call, issued and skipped as redundant. Call once per frame
     // ------------------------------------------------------------------------
-    void setMat4(const std::string &name, const glm::mat4 &mat) const
+    static UniformUploadStats takeUniformUploadStats()
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        return UniformShadow::takeFrameStats();
     }
 
 private:
+    struct Deferred {};
+
+    // active uniforms of the linked program
+    UniformTable uniforms;
+    // values last uploaded to them, written by the const setters
+    mutable UniformShadow uniformValues;
+    // build state, the shaders are kept until their status has been checked
+    GLuint pendingVertex = 0;
+    GLuint pendingFragment = 0;
+    std::string vertexName;
+    std::string fragmentName;
+    ProgramCacheKey cacheKey;
+    bool built = false;
+    bool linked = false;
+    std::function<void(Shader&)> readyCallback;
+    // what the program is built from, to rebuild it when one of its files changes
+    std::string vertexFile;
+    std::string fragmentFile;
+    ShaderDefines defines;
+    std::vector<std::string> sourceFiles;
+    uint64_t watchedChanges = 0;
+    std::unique_ptr<Shader> reloadBuild;
+
+    // reads the sources and starts the build, nothing queries its status so nothing waits on the driver
+    // ------------------------------------------------------------------------
+    Shader(const std::string& vertexFileName, const std::string& fragmentFileName, const ShaderDefines& defines, Deferred)
+        : vertexFile(vertexFileName), fragmentFile(fragmentFileName), defines(defines),
+          watchedChanges(ShaderWatcher::shared().changeCount())
+    {
+        // 1. retrieve the vertex/fragment source code, with includes resolved and defines injected,
+        // from the sources compiled into the executable or resources/shaders (see ShaderFiles)
+        ShaderSource vertexSource;
+        ShaderSource fragmentSource;
+        bool vertexPreprocessed = ShaderPreprocessor::process(vertexFileName, defines, vertexSource);
+        bool fragmentPreprocessed = ShaderPreprocessor::process(fragmentFileName, defines, fragmentSource);
+        const std::string& vertexCode = vertexSource.code;
+        const std::string& fragmentCode = fragmentSource.code;
+        // names for error messages, compile errors report the source string number of the file
+        std::string permutation = defines.empty() ? "" : " [" + defines.describe() + "]";
+        vertexName = vertexSource.describe() + permutation;
+        fragmentName = fragmentSource.describe() + permutation;
+        sourceFiles = vertexSource.files;
+        sourceFiles.insert(sourceFiles.end(), fragmentSource.files.begin(), fragmentSource.files.end());
+        ID = glCreateProgram();
+        // a missing file or #include was reported by the preprocessor, compiling the partial sources
+        // would only bury that under driver errors. The build fails, a reload retries once a file changes
+        if (!vertexPreprocessed || !fragmentPreprocessed)
+        {
+            markBuilt(false);
+            return;
+        }
+        // 2. link from the program binary cache if it's enabled and has a binary the driver accepts
+        ProgramCache& cache = ProgramCache::shared();
+        if (cache.enabled())
+        {
+            cacheKey = cache.makeKey(vertexCode, fragmentCode);
+            if (cache.load(cacheKey, ID))
+            {
+                markBuilt(true);
+                return;
+            }
+        }
+        const char* vShaderCode = vertexCode.c_str();
+        const char * fShaderCode = fragmentCode.c_str();
+        // 3. submit the compiles and the link, their status is checked once the build has finished
+        // vertex shader
+        pendingVertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(pendingVertex, 1, &vShaderCode, NULL);
+        glCompileShader(pendingVertex);
+        // fragment Shader
+        pendingFragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(pendingFragment, 1, &fShaderCode, NULL);
+        glCompileShader(pendingFragment);
+        // shader Program
+        glAttachShader(ID, pendingVertex);
+        glAttachShader(ID, pendingFragment);
+        if (cache.enabled())
+            GLExtensions::features().programParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(ID);
+    }
+    // true once the build has finished, checking it if it just has. Doesn't block where parallel compilation is supported
+    // ------------------------------------------------------------------------
+    bool pollBuild()
+    {
+        if (!built)
+        {
+            GLint completed = GL_TRUE;
+            if (GLExtensions::features().parallelShaderCompile)
+                glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &completed);
+            if (!completed)
+                return false;
+            finishBuild();
+        }
+        return true;
+    }
+    // submits a rebuild when one of the program's files has changed and swaps it in once it has linked.
+    // Until then, and for good if it fails, the previous program stays in use. The swap happens here, between draws,
+    // so a draw never sees a half built program; the uniforms are re-resolved and onReady's configure runs again
+    // ------------------------------------------------------------------------
+    void pollReload()
+    {
+        ShaderWatcher& watcher = ShaderWatcher::shared();
+        if (watcher.changeCount() != watchedChanges)
+        {
+            // a rebuild still in progress is superseded, its sources are already out of date
+            if (watcher.changedSince(watchedChanges, sourceFiles))
+                reloadBuild.reset(new Shader(vertexFile, fragmentFile, defines, Deferred{}));
+            watchedChanges = watcher.changeCount();
+        }
+        if (!reloadBuild || !reloadBuild->pollBuild())
+            return;
+
+        // an edit may have added or removed includes, watch what the new sources were assembled from
+        sourceFiles = reloadBuild->sourceFiles;
+        if (reloadBuild->linked)
+        {
+            glDeleteProgram(ID);
+            ID = std::exchange(reloadBuild->ID, 0);
+            uniforms = std::move(reloadBuild->uniforms);
+            uniformValues = std::move(reloadBuild->uniformValues);
+            vertexName = std::move(reloadBuild->vertexName);
+            fragmentName = std::move(reloadBuild->fragmentName);
+            linked = true;
+            std::cout << "INFO::SHADER::RELOADED: " << vertexFile << " + " << fragmentFile << std::endl;
+            if (readyCallback)
+                readyCallback(*this);
+        }
+        else
+        {
+            std::cout << "WARNING::SHADER::RELOAD_FAILED: " << vertexFile << " + " << fragmentFile << ", keeping the previous program" << std::endl;
+        }
+        reloadBuild.reset();
+    }
+    // checks the finished build and releases the shaders
+    // ------------------------------------------------------------------------
+    void finishBuild()
+    {
+        checkCompileErrors(pendingVertex, "VERTEX - " + vertexName);
+        checkCompileErrors(pendingFragment, "FRAGMENT - " + fragmentName);
+        checkCompileErrors(ID, "PROGRAM");
+        // delete the shaders as they're linked into our program now and no longer necessary
+        glDetachShader(ID, pendingVertex);
+        glDetachShader(ID, pendingFragment);
+        glDeleteShader(pendingVertex);
+        glDeleteShader(pendingFragment);
+        pendingVertex = 0;
+        pendingFragment = 0;
+        GLint linkStatus = GL_FALSE;
+        glGetProgramiv(ID, GL_LINK_STATUS, &linkStatus);
+        ProgramCache& cache = ProgramCache::shared();
+        if (cache.enabled() && linkStatus && !cache.store(cacheKey, ID))
+            std::cout << "WARNING::PROGRAM_CACHE::Failed to write program binary to " << cache.directory() << std::endl;
+        markBuilt(linkStatus == GL_TRUE);
+    }
+    // makes a linked program usable and runs the onReady callback
+    // ------------------------------------------------------------------------
+    void markBuilt(bool success)
+    {
+        built = true;
+        linked = success;
+        if (linked)
+        {
+            reflectUniforms();
+            if (readyCallback)
+                readyCallback(*this);
+        }
+    }
+    // false if the uniform already holds value (or doesn't exist), nothing needs to be uploaded then
+    // ------------------------------------------------------------------------
+    bool changed(UniformHandle handle, const void* value, size_t size) const
+    {
+        return handle.location >= 0 && uniformValues.update(handle.location, value, size);
+    }
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        if (pendingVertex != 0)
+            glDeleteShader(pendingVertex);
+        if (pendingFragment != 0)
+            glDeleteShader(pendingFragment);
+        if (ID != 0)
+            glDeleteProgram(ID);
+    }
+    // ------------------------------------------------------------------------
+    void takeFrom(Shader& other)
+    {
+        ID = std::exchange(other.ID, 0);
+        uniforms = std::move(other.uniforms);
+        uniformValues = std::move(other.uniformValues);
+        pendingVertex = std::exchange(other.pendingVertex, 0);
+        pendingFragment = std::exchange(other.pendingFragment, 0);
+        vertexName = std::move(other.vertexName);
+        fragmentName = std::move(other.fragmentName);
+        cacheKey = std::move(other.cacheKey);
+        built = other.built;
+        linked = other.linked;
+        readyCallback = std::move(other.readyCallback);
+        vertexFile = std::move(other.vertexFile);
+        fragmentFile = std::move(other.fragmentFile);
+        defines = std::move(other.defines);
+        sourceFiles = std::move(other.sourceFiles);
+        watchedChanges = other.watchedChanges;
+        reloadBuild = std::move(other.reloadBuild);
+    }
+
+    // fills the uniform table and sizes the shadow values, the only place glGetUniformLocation is called
+    // ------------------------------------------------------------------------
+    void reflectUniforms()
+    {
+        // linking resets every uniform to its default
+        uniformValues.clear();
+        GLint count = 0;
+        GLint maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<GLchar> nameBuffer(maxLength > 0 ? maxLength : 1);
+        std::vector<std::string> reflected;
+
+        for (GLint i = 0; i < count; i++)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID, i, static_cast<GLsizei>(nameBuffer.size()), &length, &size, &type, nameBuffer.data());
+            std::string name(nameBuffer.data(), length);
+
+            // uniform block members have no location
+            GLint location = glGetUniformLocation(ID, name.c_str());
+            if (location < 0)
+                continue;
+            uniforms.insert(name, location);
+            uniformValues.track(location, type);
+            reflected.push_back(name);
+
+            // arrays are reported once as "name[0]", also resolve the bare name and every other element
+            const std::string_view firstElement = "[0]";
+            if (name.size() > firstElement.size() && name.compare(name.size() - firstElement.size(), firstElement.size(), firstElement) == 0)
+            {
+                std::string base = name.substr(0, name.size() - firstElement.size());
+                uniforms.insert(base, location);
+                reflected.push_back(base);
+                for (GLint element = 1; element < size; element++)
+                {
+                    std::string elementName = base + "[" + std::to_string(element) + "]";
+                    GLint elementLocation = glGetUniformLocation(ID, elementName.c_str());
+                    if (elementLocation >= 0)
+                    {
+                        uniforms.insert(elementName, elementLocation);
+                        uniformValues.track(elementLocation, type);
+                        reflected.push_back(elementName);
+                    }
+                }
+            }
+        }
+
+#ifndef NDEBUG
+        // UniformIds are matched by hash alone, a collision would silently set the wrong uniform
+        for (const std::string& name : reflected)
+        {
+            if (uniforms.shadowedByHash(name))
+                std::cout << "ERROR::SHADER::UNIFORM_ID_COLLISION: " << name << " has the hash of another uniform, set it by name" << std::endl;
+        }
+#endif
+    }
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(GLuint shader, std::string type)
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#ifdef EMBEDDED_SHADERS
+// generated from resources/shaders by tools/embed_shaders.cpp, see the Makefile
+#include "embedded_shaders.h"
+#endif
+
+/**
+ * Where shader sources are read from. Builds with EMBEDDED_SHADERS (release builds, see the Makefile) compile
+ * resources/shaders into the executable and read from that table, so startup does no shader file I/O and doesn't
+ * depend on the working directory. readFromDisk switches back to the files, for editing shaders without rebuilding
+ * (and for hot reload, which watches them). Without EMBEDDED_SHADERS the files are always read.
+ * Configure before the first shader is built, context thread only.
+ */
+class ShaderFiles {
+public:
+    static constexpr const char* defaultDirectory = "resources/shaders/";
+
+    // reads from directory from now on, even if the shaders are embedded
+    static void readFromDisk(const std::string& directory = defaultDirectory) {
+        state().directory = directory;
+        state().fromDisk = true;
+    }
+
+    // true if reads come from the sources compiled into the executable
+    static bool embedded() {
+        return !state().fromDisk;
+    }
+
+    static const std::string& directory() {
+        return state().directory;
+    }
+
+    // contents of fileName (relative to the shader directory), false if there is no such file
+    static bool read(const std::string& fileName, std::string& contents) {
+#ifdef EMBEDDED_SHADERS
+        if (!state().fromDisk) {
+            const EmbeddedShaders::File* file = EmbeddedShaders::find(fileName);
+            if (!file) {
+                return false;
+            }
+            contents.assign(file->source.data(), file->source.size());
+            return true;
+        }
+#endif
+        std::ifstream file(std::filesystem::path(state().directory) / fileName, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        std::stringstream stream;
+        stream << file.rdbuf();
+        contents = stream.str();
+        return true;
+    }
+
+    // where fileName is read from, for messages
+    static std::string describe(const std::string& fileName) {
+        if (embedded()) {
+            return "<embedded>/" + fileName;
+        }
+        return (std::filesystem::path(state().directory) / fileName).string();
+    }
+
+private:
+    struct State {
+        std::string directory = defaultDirectory;
+#ifdef EMBEDDED_SHADERS
+        bool fromDisk = false;
+#else
+        bool fromDisk = true;
+#endif
+    };
+
+    static State& state() {
+        static State shaderFiles;
+        return shaderFiles;
+    }
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "shader.h"
+#include "shader_preprocessor.h"
+
+/**
+ * Variants of one vertex/fragment pair specialised through #defines (light counts, light types,
+ * texture presence), so a draw runs only the code it needs instead of branching on uniforms.
+ *
+ * A variant is submitted the first time it's asked for and built in the background like Shader::submit,
+ * callers check isReady before drawing with it. configure runs on every variant once it has linked.
+ * Variants live as long as the set, references to them stay valid. Context thread only.
+ */
+class ShaderPermutations {
+public:
+    ShaderPermutations(std::string vertexFileName, std::string fragmentFileName, std::function<void(Shader&)> configure = nullptr)
+        : vertexFileName_(std::move(vertexFileName)),
+          fragmentFileName_(std::move(fragmentFileName)),
+          configure_(std::move(configure)) {}
+
+    ShaderPermutations(const ShaderPermutations&) = delete;
+    ShaderPermutations& operator=(const ShaderPermutations&) = delete;
+
+    /**
+     * The variant built with defines, submitted now if it hasn't been asked for before.
+     * A lookup is a hash of the defines and a compare, no allocation once the variant exists.
+     */
+    Shader& get(const ShaderDefines& defines) {
+        uint64_t key = defines.hash();
+        auto range = variants_.equal_range(key);
+        for (auto variant = range.first; variant != range.second; ++variant) {
+            if (variant->second.defines == defines) {
+                return *variant->second.shader;
+            }
+        }
+
+        Variant variant;
+        variant.defines = defines;
+        variant.shader = std::make_unique<Shader>(Shader::submit(vertexFileName_, fragmentFileName_, defines));
+        if (configure_) {
+            variant.shader->onReady(configure_);
+        }
+        return *variants_.emplace(key, std::move(variant))->second.shader;
+    }
+
+    // starts building variants that will be needed soon, e.g. every light setup a scene can switch to
+    void prepare(const std::vector<ShaderDefines>& permutations) {
+        for (const ShaderDefines& defines : permutations) {
+            get(defines);
+        }
+    }
+
+    // blocks until every variant asked for so far has finished building
+    void wait() {
+        for (auto& variant : variants_) {
+            variant.second.shader->wait();
+        }
+    }
+
+    size_t variantCount() const {
+        return variants_.size();
+    }
+
+private:
+    struct Variant {
+        ShaderDefines defines;
+        std::unique_ptr<Shader> shader;
+    };
+
+    std::string vertexFileName_;
+    std::string fragmentFileName_;
+    std::function<void(Shader&)> configure_;
+    // by ShaderDefines::hash, equal_range sorts out the unlikely collision
+    std::unordered_multimap<uint64_t, Variant> variants_;
+};
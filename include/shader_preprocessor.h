@@ -0,0 +1,249 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "shader_files.h"
+
+/**
+ * #defines injected into a shader after its #version line, kept sorted by name
+ * so the same set always produces the same source and the same permutation key.
+ */
+class ShaderDefines {
+public:
+    ShaderDefines& set(const std::string& name, const std::string& value = "1") {
+        auto entry = std::lower_bound(entries_.begin(), entries_.end(), name,
+            [](const std::pair<std::string, std::string>& defined, const std::string& key) { return defined.first < key; });
+        if (entry != entries_.end() && entry->first == name) {
+            entry->second = value;
+        } else {
+            entries_.insert(entry, {name, value});
+        }
+        return *this;
+    }
+
+    ShaderDefines& set(const std::string& name, int value) {
+        return set(name, std::to_string(value));
+    }
+
+    const std::vector<std::pair<std::string, std::string>>& entries() const {
+        return entries_;
+    }
+
+    bool empty() const {
+        return entries_.empty();
+    }
+
+    // 64 bit FNV-1a over the sorted entries
+    uint64_t hash() const {
+        uint64_t value = 14695981039346656037ull;
+        auto append = [&value](std::string_view text) {
+            for (char c : text) {
+                value ^= static_cast<unsigned char>(c);
+                value *= 1099511628211ull;
+            }
+            // separator, so "AB"="C" and "A"="BC" differ
+            value ^= 0xFF;
+            value *= 1099511628211ull;
+        };
+        for (const auto& entry : entries_) {
+            append(entry.first);
+            append(entry.second);
+        }
+        return value;
+    }
+
+    // the #define lines
+    std::string source() const {
+        std::string lines;
+        for (const auto& entry : entries_) {
+            lines += "#define " + entry.first + " " + entry.second + "\n";
+        }
+        return lines;
+    }
+
+    // "A=1, B=0", for messages
+    std::string describe() const {
+        std::string description;
+        for (const auto& entry : entries_) {
+            description += (description.empty() ? "" : ", ") + entry.first + "=" + entry.second;
+        }
+        return description;
+    }
+
+    bool operator==(const ShaderDefines& other) const {
+        return entries_ == other.entries_;
+    }
+
+    bool operator!=(const ShaderDefines& other) const {
+        return entries_ != other.entries_;
+    }
+
+private:
+    std::vector<std::pair<std::string, std::string>> entries_;
+};
+
+/**
+ * A preprocessed shader: the code handed to glShaderSource and every file it was assembled from.
+ * The index of a file is the source string number #line directives give it, which is what compile errors report.
+ */
+struct ShaderSource {
+    std::string code;
+    std::vector<std::string> files;
+
+    // "main.glsl" or "main.glsl (1: common.glsl, 2: other.glsl)", to make sense of compile errors
+    std::string describe() const {
+        if (files.empty()) {
+            return "";
+        }
+        std::string description = files[0];
+        for (size_t i = 1; i < files.size(); i++) {
+            description += (i == 1 ? " (" : ", ") + std::to_string(i) + ": " + files[i];
+        }
+        return files.size() > 1 ? description + ")" : description;
+    }
+};
+
+/**
+ * Resolves #include "file" (relative to the including file, each file included once like #pragma once)
+ * and injects defines after the #version line. Files are read through ShaderFiles, embedded or from disk. GLSL has no #include, so the driver never sees one.
+ * Everything else, #if on the injected defines included, is left to the GLSL preprocessor.
+ */
+class ShaderPreprocessor {
+public:
+    // nesting deeper than this is reported instead of being followed
+    static constexpr int maxIncludeDepth = 16;
+
+    /**
+     * Preprocesses fileName (relative to the shader directory) into source. Returns false, printing the reason,
+     * if a file can't be read; source then holds whatever could be assembled.
+     */
+    static bool process(const std::string& fileName, const ShaderDefines& defines, ShaderSource& source) {
+        source = ShaderSource();
+        ShaderPreprocessor preprocessor(defines, source);
+        if (!preprocessor.readFile(fileName, 0)) {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << ShaderFiles::describe(fileName) << std::endl;
+            return false;
+        }
+        return !preprocessor.failed_;
+    }
+
+private:
+    const ShaderDefines& defines_;
+    ShaderSource& source_;
+    bool definesInjected_ = false;
+    bool failed_ = false;
+
+    ShaderPreprocessor(const ShaderDefines& defines, ShaderSource& source)
+        : defines_(defines), source_(source) {}
+
+    // fileName relative to the shader directory, false if it can't be read
+    bool readFile(const std::string& fileName, int depth) {
+        if (std::find(source_.files.begin(), source_.files.end(), fileName) != source_.files.end()) {
+            return true;
+        }
+        std::string contents;
+        if (!ShaderFiles::read(fileName, contents)) {
+            return false;
+        }
+
+        int sourceString = static_cast<int>(source_.files.size());
+        source_.files.push_back(fileName);
+        if (sourceString > 0) {
+            appendLineDirective(1, sourceString);
+        }
+
+        int lineNumber = 0;
+        for (size_t lineStart = 0; lineStart < contents.size();) {
+            size_t lineEnd = std::min(contents.find('\n', lineStart), contents.size());
+            std::string_view line(contents.data() + lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 1;
+            lineNumber++;
+            std::string_view directive = trimmed(line);
+
+            std::string includeName;
+            if (parseInclude(directive, includeName)) {
+                std::string includePath = (std::filesystem::path(fileName).parent_path() / includeName).generic_string();
+                if (depth + 1 > maxIncludeDepth) {
+                    std::cout << "ERROR::SHADER::INCLUDE_TOO_DEEP: " << includePath << " in " << fileName << ":" << lineNumber << std::endl;
+                    failed_ = true;
+                } else if (!readFile(includePath, depth + 1)) {
+                    std::cout << "ERROR::SHADER::INCLUDE_NOT_FOUND: " << includePath << " in " << fileName << ":" << lineNumber << std::endl;
+                    failed_ = true;
+                }
+                // back in this file, continue numbering after the #include line
+                appendLineDirective(lineNumber + 1, sourceString);
+                continue;
+            }
+
+            source_.code += line;
+            source_.code += '\n';
+
+            // #version has to stay the first directive, the defines follow it
+            if (depth == 0 && !definesInjected_ && directive.rfind("#version", 0) == 0) {
+                injectDefines(lineNumber + 1);
+            }
+        }
+
+        if (depth == 0 && !definesInjected_) {
+            // no #version, the defines go first
+            source_.code.insert(0, defines_.source());
+            definesInjected_ = true;
+        }
+        return true;
+    }
+
+    void injectDefines(int nextLine) {
+        definesInjected_ = true;
+        if (defines_.empty()) {
+            return;
+        }
+        source_.code += defines_.source();
+        appendLineDirective(nextLine, 0);
+    }
+
+    // the next line is reported as line of source string sourceString
+    void appendLineDirective(int line, int sourceString) {
+        source_.code += "#line " + std::to_string(line) + " " + std::to_string(sourceString) + "\n";
+    }
+
+    // without leading whitespace and the \r of CRLF files
+    static std::string_view trimmed(std::string_view line) {
+        std::string_view view(line);
+        size_t first = view.find_first_not_of(" \t");
+        if (first == std::string_view::npos) {
+            return std::string_view();
+        }
+        view.remove_prefix(first);
+        if (!view.empty() && view.back() == '\r') {
+            view.remove_suffix(1);
+        }
+        return view;
+    }
+
+    // #include "name", whitespace allowed after the #
+    static bool parseInclude(std::string_view directive, std::string& name) {
+        if (directive.empty() || directive[0] != '#') {
+            return false;
+        }
+        directive.remove_prefix(1);
+        size_t keyword = directive.find_first_not_of(" \t");
+        if (keyword == std::string_view::npos || directive.compare(keyword, 7, "include") != 0) {
+            return false;
+        }
+        directive.remove_prefix(keyword + 7);
+        size_t open = directive.find('"');
+        size_t close = open == std::string_view::npos ? open : directive.find('"', open + 1);
+        if (close == std::string_view::npos) {
+            return false;
+        }
+        name = std::string(directive.substr(open + 1, close - open - 1));
+        return true;
+    }
+};
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Watches the shader directory for saved files so programs built from them can be rebuilt while the app runs
+ * (see Shader::isReady), instead of restarting it and reloading every model and texture.
+ *
+ * Uses inotify on Linux. Elsewhere, or if inotify isn't available, the directory's modification times are
+ * compared every pollInterval. Only files directly in the directory are watched. Every change bumps changeCount,
+ * a program remembers the count it was built at and asks changedSince whether any of its files changed after it.
+ * Context thread only, poll is called once per frame.
+ */
+class ShaderWatcher {
+public:
+    // between modification time scans of the fallback
+    static constexpr std::chrono::milliseconds pollInterval{250};
+
+    static ShaderWatcher& shared() {
+        static ShaderWatcher watcher;
+        return watcher;
+    }
+
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    ~ShaderWatcher() {
+        stop();
+    }
+
+    // starts watching directory, false (printing why) if it can't be watched
+    bool start(const std::string& directory = "resources/shaders/") {
+        stop();
+        directory_ = directory;
+        std::error_code error;
+        if (!std::filesystem::is_directory(directory_, error)) {
+            std::cout << "ERROR::SHADER_WATCHER::NOT_A_DIRECTORY: " << directory_.string() << std::endl;
+            return false;
+        }
+
+#ifdef __linux__
+        inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd_ >= 0 && inotify_add_watch(inotifyFd_, directory_.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) >= 0) {
+            active_ = true;
+            return true;
+        }
+        std::cout << "WARNING::SHADER_WATCHER::inotify unavailable, polling modification times instead" << std::endl;
+        closeInotify();
+#endif
+        scanModificationTimes(false);
+        nextScan_ = std::chrono::steady_clock::now() + pollInterval;
+        active_ = true;
+        return true;
+    }
+
+    void stop() {
+#ifdef __linux__
+        closeInotify();
+#endif
+        active_ = false;
+        modified_.clear();
+    }
+
+    bool active() const {
+        return active_;
+    }
+
+    // picks up the files saved since the last poll
+    void poll() {
+        if (!active_) {
+            return;
+        }
+#ifdef __linux__
+        if (inotifyFd_ >= 0) {
+            readEvents();
+            return;
+        }
+#endif
+        auto now = std::chrono::steady_clock::now();
+        if (now >= nextScan_) {
+            scanModificationTimes(true);
+            nextScan_ = now + pollInterval;
+        }
+    }
+
+    // bumped by every change, a program compares it against the count it was built at
+    uint64_t changeCount() const {
+        return changeCount_;
+    }
+
+    // true if any of files (relative to the directory) changed after changeCount was count
+    bool changedSince(uint64_t count, const std::vector<std::string>& files) const {
+        if (everythingChangedAt_ > count) {
+            return true;
+        }
+        for (const std::string& file : files) {
+            auto change = changedAt_.find(file);
+            if (change != changedAt_.end() && change->second > count) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::filesystem::path directory_;
+    bool active_ = false;
+    uint64_t changeCount_ = 0;
+    // file -> changeCount_ of its last change
+    std::unordered_map<std::string, uint64_t> changedAt_;
+    // set when events were lost, every program is rebuilt then
+    uint64_t everythingChangedAt_ = 0;
+
+    // fallback state
+    std::unordered_map<std::string, std::filesystem::file_time_type> modified_;
+    std::chrono::steady_clock::time_point nextScan_;
+
+    ShaderWatcher() = default;
+
+    void markChanged(const std::string& file) {
+        changedAt_[file] = ++changeCount_;
+    }
+
+    // records the directory's modification times, marking the files whose time moved if report is set
+    void scanModificationTimes(bool report) {
+        std::error_code error;
+        for (std::filesystem::directory_iterator entry(directory_, error), end; !error && entry != end; entry.increment(error)) {
+            if (!entry->is_regular_file(error)) {
+                continue;
+            }
+            std::filesystem::file_time_type time = entry->last_write_time(error);
+            if (error) {
+                continue;
+            }
+            std::string file = entry->path().filename().string();
+            auto known = modified_.find(file);
+            if (known == modified_.end() || known->second != time) {
+                if (report) {
+                    markChanged(file);
+                }
+                modified_[file] = time;
+            }
+        }
+    }
+
+#ifdef __linux__
+    int inotifyFd_ = -1;
+
+    void readEvents() {
+        alignas(inotify_event) char buffer[4096];
+        while (true) {
+            ssize_t length = read(inotifyFd_, buffer, sizeof(buffer));
+            if (length <= 0) {
+                if (length < 0 && errno != EAGAIN && errno != EINTR) {
+                    std::cout << "WARNING::SHADER_WATCHER::inotify read failed, no longer watching" << std::endl;
+                    stop();
+                }
+                return;
+            }
+            for (char* next = buffer; next < buffer + length;) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(next);
+                if (event->mask & IN_Q_OVERFLOW) {
+                    everythingChangedAt_ = ++changeCount_;
+                } else if (event->len > 0) {
+                    markChanged(event->name);
+                }
+                next += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+
+    void closeInotify() {
+        if (inotifyFd_ >= 0) {
+            close(inotifyFd_);
+            inotifyFd_ = -1;
+        }
+    }
+#endif
+};
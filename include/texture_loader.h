@@ -0,0 +1,247 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include "bounded_queue.h"
+#include "thread_pool.h"
+
+enum class TextureWrap {
+    Repeat,
+    // clamp images with an alpha channel (e.g. foliage, windows) so their edges don't bleed
+    ClampToEdgeIfAlpha
+};
+
+struct TextureRequest {
+    std::string path;
+    bool flipVertically = false;
+    unsigned int textureID = 0;
+    // GL_TEXTURE_2D, or the cube map face the image is uploaded to
+    GLenum target = GL_TEXTURE_2D;
+    TextureWrap wrap = TextureWrap::Repeat;
+};
+
+struct DecodedImage {
+    TextureRequest request;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::unique_ptr<unsigned char, void (*)(void*)> pixels{nullptr, stbi_image_free};
+
+    size_t byteSize() const {
+        return size_t(width) * size_t(height) * size_t(channels);
+    }
+};
+
+/**
+ * Decodes the requested image, safe to call from any thread.
+ * The flip flag is applied per thread, the global stbi flip state is left untouched.
+ * On failure the returned image has no pixels.
+ */
+inline DecodedImage decodeImage(TextureRequest request) {
+    DecodedImage image;
+    stbi_set_flip_vertically_on_load_thread(request.flipVertically);
+    image.pixels.reset(stbi_load(request.path.c_str(), &image.width, &image.height, &image.channels, 0));
+    image.request = std::move(request);
+    return image;
+}
+
+/**
+ * Decodes textures on the worker pool and uploads them on the GL context thread.
+ *
+ * load2D/loadCubeMap reserve the texture name immediately and return it, the image data arrives later:
+ * decoded images wait in a bounded queue until the context thread drains it with uploadPending,
+ * typically once per frame under a byte budget. Until then the texture is incomplete and samples black.
+ * All member functions must be called on the context thread.
+ */
+class TextureLoader {
+public:
+    explicit TextureLoader(size_t queueCapacity = 8, ThreadPool& pool = ThreadPool::shared())
+        : pool_(pool), decoded_(queueCapacity) {}
+
+    ~TextureLoader() {
+        // unblock workers waiting on a full queue and wait for in flight decodes
+        decoded_.close();
+        while (inFlight_ > 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    static TextureLoader& shared() {
+        static TextureLoader loader;
+        return loader;
+    }
+
+    unsigned int load2D(const std::string& path, bool flipVertically = false, TextureWrap wrap = TextureWrap::Repeat) {
+        unsigned int textureID;
+        glGenTextures(1, &textureID);
+
+        TextureRequest request;
+        request.path = path;
+        request.flipVertically = flipVertically;
+        request.textureID = textureID;
+        request.target = GL_TEXTURE_2D;
+        request.wrap = wrap;
+        submit(std::move(request));
+
+        return textureID;
+    }
+
+    /**
+     * facePaths are given in GL face order: +X, -X, +Y, -Y, +Z, -Z.
+     */
+    unsigned int loadCubeMap(const std::vector<std::string>& facePaths, bool flipVertically = false) {
+        unsigned int cubeMapID;
+        glGenTextures(1, &cubeMapID);
+
+        glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMapID);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+        for (size_t i = 0; i < facePaths.size(); i++) {
+            TextureRequest request;
+            request.path = facePaths[i];
+            request.flipVertically = flipVertically;
+            request.textureID = cubeMapID;
+            request.target = GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<GLenum>(i);
+            submit(std::move(request));
+        }
+
+        return cubeMapID;
+    }
+
+    /**
+     * Uploads decoded images until byteBudget is used up, at least one image is uploaded if one is ready.
+     * Returns the number of images uploaded.
+     */
+    size_t uploadPending(size_t byteBudget) {
+        size_t uploadedImages = 0;
+        size_t uploadedBytes = 0;
+
+        DecodedImage image;
+        while (uploadedBytes < byteBudget && decoded_.tryPop(image)) {
+            uploadedBytes += image.byteSize();
+            upload(image);
+            uploadedImages++;
+        }
+        return uploadedImages;
+    }
+
+    /**
+     * Blocks until every requested image has been decoded and uploaded.
+     */
+    void finish() {
+        DecodedImage image;
+        while (pendingCount() > 0 && decoded_.pop(image)) {
+            upload(image);
+        }
+    }
+
+    // images requested but not uploaded yet
+    size_t pendingCount() const {
+        return requested_ - processed_;
+    }
+
+    /**
+     * Deletes a texture created by this loader.
+     * If images for it are still being decoded, deletion is deferred until they arrive,
+     * so the name can't be reused by another texture before its stale upload lands.
+     */
+    void release(unsigned int textureID) {
+        auto pending = pendingImages_.find(textureID);
+        if (pending == pendingImages_.end()) {
+            glDeleteTextures(1, &textureID);
+            return;
+        }
+        pending->second.released = true;
+    }
+
+private:
+    ThreadPool& pool_;
+    BoundedQueue<DecodedImage> decoded_;
+    std::atomic<size_t> inFlight_{0};
+    size_t requested_ = 0;
+    size_t processed_ = 0;
+
+    struct PendingTexture {
+        unsigned int images = 0;
+        bool released = false;
+    };
+    std::unordered_map<unsigned int, PendingTexture> pendingImages_;
+
+    void submit(TextureRequest request) {
+        requested_++;
+        pendingImages_[request.textureID].images++;
+        inFlight_++;
+        pool_.submit([this, request = std::move(request)]() mutable {
+            decoded_.push(decodeImage(std::move(request)));
+            inFlight_--;
+        });
+    }
+
+    void upload(const DecodedImage& image) {
+        processed_++;
+
+        const TextureRequest& request = image.request;
+        auto pending = pendingImages_.find(request.textureID);
+        if (pending != pendingImages_.end()) {
+            bool released = pending->second.released;
+            if (--pending->second.images == 0) {
+                pendingImages_.erase(pending);
+                if (released) {
+                    glDeleteTextures(1, &request.textureID);
+                }
+            }
+            if (released) {
+                return;
+            }
+        }
+
+        if (!image.pixels) {
+            std::cout << "Texture failed to load at path: " << request.path << std::endl;
+            return;
+        }
+
+        GLenum format = GL_RGB;
+        if (image.channels == 1) {
+            format = GL_RED;
+        } else if (image.channels == 4) {
+            format = GL_RGBA;
+        }
+
+        if (request.target != GL_TEXTURE_2D) {
+            glBindTexture(GL_TEXTURE_CUBE_MAP, request.textureID);
+            glTexImage2D(request.target, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels.get());
+            return;
+        }
+
+        GLint wrap = GL_REPEAT;
+        if (request.wrap == TextureWrap::ClampToEdgeIfAlpha && image.channels == 4) {
+            wrap = GL_CLAMP_TO_EDGE;
+        }
+
+        glBindTexture(GL_TEXTURE_2D, request.textureID);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels.get());
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+};
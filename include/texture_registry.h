@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "texture_loader.h"
+
+/**
+ * A GL texture owned by the TextureRegistry, released once the last handle to it goes away.
+ */
+struct TextureResource {
+    unsigned int id = 0;
+    GLenum target = GL_TEXTURE_2D;
+};
+
+using TextureHandle = std::shared_ptr<const TextureResource>;
+
+/**
+ * Process-wide texture cache shared by every Model and the demo loaders.
+ *
+ * Textures are looked up by canonical path (plus the decode options that change their contents),
+ * so an image referenced from several models or materials is decoded and uploaded exactly once.
+ * Handles are reference counted, the GL texture is deleted when the last one is dropped.
+ * Like the TextureLoader it is context thread only, handles must also be released on that thread.
+ */
+class TextureRegistry {
+public:
+    static TextureRegistry& shared() {
+        static TextureRegistry registry;
+        return registry;
+    }
+
+    TextureRegistry(const TextureRegistry&) = delete;
+    TextureRegistry& operator=(const TextureRegistry&) = delete;
+
+    TextureHandle load2D(const std::string& path, bool flipVertically = false, TextureWrap wrap = TextureWrap::Repeat) {
+        std::string key = canonicalPath(path);
+        key += flipVertically ? "|flip" : "|noflip";
+        key += wrap == TextureWrap::Repeat ? "|repeat" : "|clamp-alpha";
+
+        if (TextureHandle existing = find(key)) {
+            return existing;
+        }
+        return insert(key, loader_.load2D(path, flipVertically, wrap), GL_TEXTURE_2D);
+    }
+
+    /**
+     * facePaths are given in GL face order: +X, -X, +Y, -Y, +Z, -Z.
+     */
+    TextureHandle loadCubeMap(const std::vector<std::string>& facePaths, bool flipVertically = false) {
+        std::string key = "cube";
+        for (const std::string& facePath : facePaths) {
+            key += "|" + canonicalPath(facePath);
+        }
+        key += flipVertically ? "|flip" : "|noflip";
+
+        if (TextureHandle existing = find(key)) {
+            return existing;
+        }
+        return insert(key, loader_.loadCubeMap(facePaths, flipVertically), GL_TEXTURE_CUBE_MAP);
+    }
+
+    // textures currently alive
+    size_t size() const {
+        return entries_.size();
+    }
+
+    // lookups answered from the registry, and lookups that had to decode a new texture
+    size_t hitCount() const {
+        return hits_;
+    }
+
+    size_t missCount() const {
+        return misses_;
+    }
+
+private:
+    // the registry must not outlive the loader it releases textures through
+    TextureLoader& loader_ = TextureLoader::shared();
+    std::unordered_map<std::string, std::weak_ptr<const TextureResource>> entries_;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+
+    TextureRegistry() = default;
+
+    static std::string canonicalPath(const std::string& path) {
+        std::error_code error;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+        if (error) {
+            return std::filesystem::path(path).lexically_normal().generic_string();
+        }
+        return canonical.generic_string();
+    }
+
+    TextureHandle find(const std::string& key) {
+        auto entry = entries_.find(key);
+        if (entry == entries_.end()) {
+            return nullptr;
+        }
+
+        TextureHandle handle = entry->second.lock();
+        if (handle) {
+            hits_++;
+        }
+        return handle;
+    }
+
+    TextureHandle insert(const std::string& key, unsigned int textureID, GLenum target) {
+        misses_++;
+
+        TextureResource* resource = new TextureResource{textureID, target};
+        TextureHandle handle(resource, [this, key](const TextureResource* released) {
+            entries_.erase(key);
+            loader_.release(released->id);
+            delete released;
+        });
+
+        entries_[key] = handle;
+        return handle;
+    }
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed size pool of worker threads consuming a FIFO job queue.
+ * Jobs must not touch the GL context, only the thread that owns it may do that.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned int threadCount = defaultThreadCount()) {
+        threadCount = std::max(threadCount, 1u);
+        for (unsigned int i = 0; i < threadCount; i++) {
+            workers_.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        condition_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Process-wide pool shared by the asset loaders.
+     */
+    static ThreadPool& shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    static unsigned int defaultThreadCount() {
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        // leave one core for the render thread
+        return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    size_t threadCount() const {
+        return workers_.size();
+    }
+
+    void submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs_.push(std::move(job));
+        }
+        condition_.notify_one();
+    }
+
+    /**
+     * Calls fn(i) for every i in [0, count) and returns once all calls have completed.
+     * The calling thread works on the range too, so this never deadlocks waiting for busy workers.
+     * The order in which indices are processed is unspecified.
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+        if (count == 0) {
+            return;
+        }
+
+        struct State {
+            std::atomic<size_t> next{0};
+            std::atomic<size_t> completed{0};
+            size_t count;
+            const std::function<void(size_t)>* fn;
+            std::mutex mutex;
+            std::condition_variable done;
+        };
+
+        // helpers that start after the range is exhausted still reference the state
+        auto state = std::make_shared<State>();
+        state->count = count;
+        state->fn = &fn;
+
+        auto work = [](State& s) {
+            for (size_t i = s.next++; i < s.count; i = s.next++) {
+                (*s.fn)(i);
+                if (++s.completed == s.count) {
+                    std::lock_guard<std::mutex> lock(s.mutex);
+                    s.done.notify_all();
+                }
+            }
+        };
+
+        size_t helpers = std::min(count - 1, workers_.size());
+        for (size_t i = 0; i < helpers; i++) {
+            submit([state, work] { work(*state); });
+        }
+
+        work(*state);
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait(lock, [&state] { return state->completed == state->count; });
+    }
+
+private:
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> jobs_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool stopping_ = false;
+
+    void workerLoop() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                condition_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+                if (stopping_ && jobs_.empty()) {
+                    return;
+                }
+                job = std::move(jobs_.front());
+                jobs_.pop();
+            }
+            job();
+        }
+    }
+};
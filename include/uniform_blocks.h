@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "uniform_struct.h"
+
+/*
+ * CPU mirrors of the std140 uniform blocks declared by the shaders in resources/shaders.
+ * A vec3 is aligned to 16 bytes in std140, hence the explicit padding after the glm::vec3 members.
+ * A block's blockName and binding are what programs pass to Shader::bindUniformBlock.
+ * The light structs also have UniformFields, so they can set the same GLSL structs declared as plain
+ * struct or array uniforms through UniformStruct.
+ */
+
+// layout (std140) uniform Frame, per frame camera state
+struct FrameBlock {
+    static constexpr const char* blockName = "Frame";
+    static constexpr GLuint binding = 0;
+
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+    glm::vec3 viewPosition = glm::vec3(0.0f);
+    float padding0 = 0.0f;
+};
+
+struct DirectionalLightBlock {
+    glm::vec3 direction = glm::vec3(0.0f);
+    float padding0 = 0.0f;
+
+    glm::vec3 ambient = glm::vec3(0.0f);
+    float padding1 = 0.0f;
+    glm::vec3 diffuse = glm::vec3(0.0f);
+    float padding2 = 0.0f;
+    glm::vec3 specular = glm::vec3(0.0f);
+    float padding3 = 0.0f;
+};
+
+struct PointLightBlock {
+    glm::vec3 position = glm::vec3(0.0f);
+
+    float constant = 1.0f;
+    float linear = 0.0f;
+    float quadratic = 0.0f;
+    float padding0[2] = {};
+
+    glm::vec3 ambient = glm::vec3(0.0f);
+    float padding1 = 0.0f;
+    glm::vec3 diffuse = glm::vec3(0.0f);
+    float padding2 = 0.0f;
+    glm::vec3 specular = glm::vec3(0.0f);
+    float padding3 = 0.0f;
+};
+
+struct SpotLightBlock {
+    glm::vec3 position = glm::vec3(0.0f);
+    float padding0 = 0.0f;
+    glm::vec3 direction = glm::vec3(0.0f);
+    float innerCutOff = 0.0f;
+    float outerCutOff = 0.0f;
+
+    float constant = 1.0f;
+    float linear = 0.0f;
+    float quadratic = 0.0f;
+
+    glm::vec3 ambient = glm::vec3(0.0f);
+    float padding1 = 0.0f;
+    glm::vec3 diffuse = glm::vec3(0.0f);
+    float padding2 = 0.0f;
+    glm::vec3 specular = glm::vec3(0.0f);
+    float padding3 = 0.0f;
+};
+
+// layout (std140) uniform Lights, the full light set of the lit shaders
+struct LightsBlock {
+    static constexpr const char* blockName = "Lights";
+    static constexpr GLuint binding = 1;
+    static constexpr int pointLightCount = 4;
+
+    DirectionalLightBlock dirLight;
+    PointLightBlock pointLights[pointLightCount];
+    SpotLightBlock spotLight;
+};
+
+// std140 offsets, as the GL would report them through GL_UNIFORM_OFFSET
+static_assert(offsetof(FrameBlock, viewPosition) == 64 && sizeof(FrameBlock) == 80, "Frame block must match std140");
+static_assert(sizeof(DirectionalLightBlock) == 64, "DirectionalLight must match std140");
+static_assert(offsetof(PointLightBlock, constant) == 12 && offsetof(PointLightBlock, ambient) == 32
+    && sizeof(PointLightBlock) == 80, "PointLight must match std140");
+static_assert(offsetof(SpotLightBlock, direction) == 16 && offsetof(SpotLightBlock, outerCutOff) == 32
+    && offsetof(SpotLightBlock, ambient) == 48 && sizeof(SpotLightBlock) == 96, "SpotLight must match std140");
+static_assert(offsetof(LightsBlock, pointLights) == 64 && offsetof(LightsBlock, spotLight) == 384
+    && sizeof(LightsBlock) == 480, "Lights block must match std140");
+
+// uniform Material material, the lit shaders' sampler units and shininess
+struct MaterialUniforms {
+    int diffuse = 0;
+    int specular = 1;
+    float shininess = 32.0f;
+};
+
+template <>
+struct UniformFields<MaterialUniforms> {
+    static constexpr auto fields = std::make_tuple(
+        uniformField("diffuse", &MaterialUniforms::diffuse),
+        uniformField("specular", &MaterialUniforms::specular),
+        uniformField("shininess", &MaterialUniforms::shininess));
+};
+
+template <>
+struct UniformFields<DirectionalLightBlock> {
+    static constexpr auto fields = std::make_tuple(
+        uniformField("direction", &DirectionalLightBlock::direction),
+        uniformField("ambient", &DirectionalLightBlock::ambient),
+        uniformField("diffuse", &DirectionalLightBlock::diffuse),
+        uniformField("specular", &DirectionalLightBlock::specular));
+};
+
+template <>
+struct UniformFields<PointLightBlock> {
+    static constexpr auto fields = std::make_tuple(
+        uniformField("position", &PointLightBlock::position),
+        uniformField("constant", &PointLightBlock::constant),
+        uniformField("linear", &PointLightBlock::linear),
+        uniformField("quadratic", &PointLightBlock::quadratic),
+        uniformField("ambient", &PointLightBlock::ambient),
+        uniformField("diffuse", &PointLightBlock::diffuse),
+        uniformField("specular", &PointLightBlock::specular));
+};
+
+template <>
+struct UniformFields<SpotLightBlock> {
+    static constexpr auto fields = std::make_tuple(
+        uniformField("position", &SpotLightBlock::position),
+        uniformField("direction", &SpotLightBlock::direction),
+        uniformField("innerCutOff", &SpotLightBlock::innerCutOff),
+        uniformField("outerCutOff", &SpotLightBlock::outerCutOff),
+        uniformField("constant", &SpotLightBlock::constant),
+        uniformField("linear", &SpotLightBlock::linear),
+        uniformField("quadratic", &SpotLightBlock::quadratic),
+        uniformField("ambient", &SpotLightBlock::ambient),
+        uniformField("diffuse", &SpotLightBlock::diffuse),
+        uniformField("specular", &SpotLightBlock::specular));
+};
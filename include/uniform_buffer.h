@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "gl_resource.h"
+
+/**
+ * A std140 uniform block shared by every program that binds it to BlockT::binding.
+ *
+ * BlockT is the CPU mirror of the block, laid out to match std140, with static constexpr
+ * blockName and binding members. Write data() as often as needed, then upload() it once per frame.
+ * Context thread only.
+ */
+template <typename BlockT>
+class UniformBuffer {
+public:
+    UniformBuffer() : buffer_(GLBuffer::create()) {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer_.get());
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(BlockT), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        bind();
+    }
+
+    BlockT& data() {
+        return data_;
+    }
+
+    const BlockT& data() const {
+        return data_;
+    }
+
+    // copies the whole mirror to the GPU with a single glBufferSubData
+    void upload() const {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer_.get());
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BlockT), &data_);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    // attaches the buffer to the block's binding point, only needed again if something else was bound there
+    void bind() const {
+        glBindBufferBase(GL_UNIFORM_BUFFER, BlockT::binding, buffer_.get());
+    }
+
+private:
+    GLBuffer buffer_;
+    BlockT data_{};
+};
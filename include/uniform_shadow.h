@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <glad/glad.h>
+
+/**
+ * glUniform* calls issued and skipped because the program already held the value.
+ * Kept raw so the counts of several frames can be summed before computing ratios.
+ */
+struct UniformUploadStats {
+    size_t issued = 0;
+    size_t skipped = 0;
+
+    UniformUploadStats& operator+=(const UniformUploadStats& other) {
+        issued += other.issued;
+        skipped += other.skipped;
+        return *this;
+    }
+};
+
+/**
+ * CPU copy of the values last uploaded to a program's uniforms, by location, so setting a uniform to the value
+ * it already holds (sampler units, material constants, anything set every frame that rarely changes) costs a
+ * memcmp instead of a GL call. Uniform values are per program state, so the copy stays right whichever program
+ * is bound. It is only wrong if the program's uniforms are changed behind its back with a raw glUniform* call.
+ *
+ * A location starts out unknown, its first set is always issued. Cleared whenever the program (re)links.
+ */
+class UniformShadow {
+public:
+    // forgets every value, called when the program is (re)linked and its uniforms are back at their defaults
+    void clear() {
+        slots_.clear();
+        values_.clear();
+    }
+
+    // reserves room for a location's value, type as reported by glGetActiveUniform (one array element)
+    void track(GLint location, GLenum type) {
+        if (location < 0) {
+            return;
+        }
+        if (static_cast<size_t>(location) >= slots_.size()) {
+            slots_.resize(location + 1);
+        }
+        Slot& slot = slots_[location];
+        slot.offset = static_cast<uint32_t>(values_.size());
+        slot.capacity = static_cast<uint32_t>(valueSize(type));
+        slot.known = false;
+        values_.resize(values_.size() + slot.capacity);
+    }
+
+    /**
+     * True if the value has to be uploaded, i.e. it differs from the one last uploaded to location or that
+     * one isn't known, and records it as uploaded. Counts the outcome in frameStats.
+     * @precondition location >= 0
+     */
+    bool update(GLint location, const void* value, size_t size) {
+        if (static_cast<size_t>(location) >= slots_.size() || size > slots_[location].capacity) {
+            // not reflected, or not the type it was reflected as, let GL deal with it
+            frameStats().issued++;
+            return true;
+        }
+        Slot& slot = slots_[location];
+        unsigned char* stored = values_.data() + slot.offset;
+        if (slot.known && slot.size == size && std::memcmp(stored, value, size) == 0) {
+            frameStats().skipped++;
+            return false;
+        }
+        std::memcpy(stored, value, size);
+        slot.size = static_cast<uint32_t>(size);
+        slot.known = true;
+        frameStats().issued++;
+        return true;
+    }
+
+    // uniform updates of every program since the last takeFrameStats
+    static UniformUploadStats& frameStats() {
+        static UniformUploadStats stats;
+        return stats;
+    }
+
+    // returns the counts so far and starts over, called once per frame
+    static UniformUploadStats takeFrameStats() {
+        UniformUploadStats stats = frameStats();
+        frameStats() = UniformUploadStats();
+        return stats;
+    }
+
+    // bytes of one value of a uniform type, types the Shader setters can't write get room for an int
+    static size_t valueSize(GLenum type) {
+        switch (type) {
+            case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_BOOL_VEC2:
+                return 8;
+            case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3:
+                return 12;
+            case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_BOOL_VEC4:
+            case GL_FLOAT_MAT2:
+                return 16;
+            case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT3x2:
+                return 24;
+            case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT4x2:
+                return 32;
+            case GL_FLOAT_MAT3:
+                return 36;
+            case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x3:
+                return 48;
+            case GL_FLOAT_MAT4:
+                return 64;
+            default:
+                // scalars and samplers
+                return 4;
+        }
+    }
+
+private:
+    struct Slot {
+        uint32_t offset = 0;
+        uint32_t capacity = 0;
+        uint32_t size = 0;
+        bool known = false;
+    };
+
+    // by location, unreflected locations have no capacity
+    std::vector<Slot> slots_;
+    std::vector<unsigned char> values_;
+};
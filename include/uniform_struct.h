@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <glm/glm.hpp>
+
+#include "shader.h"
+#include "uniform_table.h"
+
+/**
+ * A C++ struct member and the name of the GLSL struct member it mirrors.
+ */
+template <typename Struct, typename Member>
+struct UniformField {
+    const char* name;
+    Member Struct::* member;
+};
+
+template <typename Struct, typename Member>
+constexpr UniformField<Struct, Member> uniformField(const char* name, Member Struct::* member) {
+    return UniformField<Struct, Member>{name, member};
+}
+
+/**
+ * The field list of a C++ struct that mirrors a GLSL struct, written once next to the struct:
+ *
+ *     template <> struct UniformFields<MaterialUniforms> {
+ *         static constexpr auto fields = std::make_tuple(
+ *             uniformField("diffuse", &MaterialUniforms::diffuse), ...);
+ *     };
+ *
+ * Members without a GLSL counterpart, like std140 padding, are left out.
+ */
+template <typename Struct>
+struct UniformFields;
+
+// the Shader setter for each member type a field list may use
+namespace UniformValue {
+    inline void set(const Shader& shader, UniformHandle handle, bool value) { shader.setBool(handle, value); }
+    inline void set(const Shader& shader, UniformHandle handle, int value) { shader.setInt(handle, value); }
+    inline void set(const Shader& shader, UniformHandle handle, float value) { shader.setFloat(handle, value); }
+    inline void set(const Shader& shader, UniformHandle handle, const glm::vec2& value) { shader.setVec2(handle, value); }
+    inline void set(const Shader& shader, UniformHandle handle, const glm::vec3& value) { shader.setVec3(handle, value); }
+    inline void set(const Shader& shader, UniformHandle handle, const glm::vec4& value) { shader.setVec4(handle, value); }
+    inline void set(const Shader& shader, UniformHandle handle, const glm::mat2& value) { shader.setMat2(handle, value); }
+    inline void set(const Shader& shader, UniformHandle handle, const glm::mat3& value) { shader.setMat3(handle, value); }
+    inline void set(const Shader& shader, UniformHandle handle, const glm::mat4& value) { shader.setMat4(handle, value); }
+}
+
+/**
+ * Binds a GLSL struct uniform ("uniform Material material;"), or with ArraySize an array of them
+ * ("uniform PointLight pointLights[4];"), to its C++ mirror through UniformFields.
+ *
+ * resolve looks up every member's location once, after the program has linked (in the configure passed to onReady,
+ * which also runs after a hot reload). upload then sets each member through the precomputed handles, without
+ * building or hashing names, and like every Shader setter skips the values the program already holds.
+ * Members the GLSL compiler optimized out resolve to -1 and are skipped. Bound to the program it was resolved for.
+ */
+template <typename Struct, size_t ArraySize = 0>
+class UniformStruct {
+public:
+    static constexpr size_t fieldCount = std::tuple_size_v<std::decay_t<decltype(UniformFields<Struct>::fields)>>;
+    // a struct that isn't an array is one element
+    static constexpr size_t elementCount = ArraySize == 0 ? 1 : ArraySize;
+
+    explicit UniformStruct(std::string_view name) : name_(name) {}
+
+    void resolve(const Shader& shader) {
+        for (size_t element = 0; element < elementCount; element++) {
+            UniformId base = ArraySize == 0 ? name_ : name_[static_cast<unsigned int>(element)];
+            resolveFields(shader, base, &handles_[element * fieldCount], std::make_index_sequence<fieldCount>());
+        }
+    }
+
+    // sets every member of the struct, or of the first element of an array
+    void upload(const Shader& shader, const Struct& value) const {
+        upload(shader, 0, value);
+    }
+
+    // sets every member of one array element
+    void upload(const Shader& shader, size_t element, const Struct& value) const {
+        uploadFields(shader, &handles_[element * fieldCount], value, std::make_index_sequence<fieldCount>());
+    }
+
+    // sets the whole array, one pass over the precomputed handles
+    void upload(const Shader& shader, const std::array<Struct, elementCount>& values) const {
+        for (size_t element = 0; element < elementCount; element++) {
+            upload(shader, element, values[element]);
+        }
+    }
+
+    UniformHandle handle(size_t element, size_t field) const {
+        return handles_[element * fieldCount + field];
+    }
+
+private:
+    UniformId name_;
+    std::array<UniformHandle, fieldCount * elementCount> handles_{};
+
+    template <size_t... Fields>
+    static void resolveFields(const Shader& shader, UniformId base, UniformHandle* handles, std::index_sequence<Fields...>) {
+        ((handles[Fields] = shader.uniform(base.member(std::get<Fields>(UniformFields<Struct>::fields).name))), ...);
+    }
+
+    template <size_t... Fields>
+    static void uploadFields(const Shader& shader, const UniformHandle* handles, const Struct& value, std::index_sequence<Fields...>) {
+        (UniformValue::set(shader, handles[Fields], value.*(std::get<Fields>(UniformFields<Struct>::fields).member)), ...);
+    }
+};
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <glad/glad.h>
+
+/**
+ * A uniform name by its 32 bit FNV-1a hash, usable wherever Shader takes a name.
+ * FNV-1a hashes one character at a time, so array elements and struct members are composed from a prefix's
+ * hash without building the full name: "pointLights"_u[2].member("position") == "pointLights[2].position"_u.
+ */
+class UniformId {
+public:
+    constexpr explicit UniformId(std::string_view name) : hash_(append(offsetBasis, name)) {}
+
+    // element index of an array uniform
+    constexpr UniformId operator[](unsigned int index) const {
+        char digits[10] = {};
+        int count = 0;
+        do {
+            digits[count++] = static_cast<char>('0' + index % 10);
+            index /= 10;
+        } while (index > 0);
+
+        uint32_t value = append(hash_, "[");
+        while (count > 0) {
+            value = append(value, std::string_view(&digits[--count], 1));
+        }
+        return fromHash(append(value, "]"));
+    }
+
+    // field of a struct uniform
+    constexpr UniformId member(std::string_view name) const {
+        return fromHash(append(append(hash_, "."), name));
+    }
+
+    constexpr uint32_t hash() const {
+        return hash_;
+    }
+
+    constexpr bool operator==(UniformId other) const {
+        return hash_ == other.hash_;
+    }
+
+    constexpr bool operator!=(UniformId other) const {
+        return hash_ != other.hash_;
+    }
+
+    // continues the hash of a prefix with text
+    static constexpr uint32_t append(uint32_t value, std::string_view text) {
+        for (char c : text) {
+            value ^= static_cast<unsigned char>(c);
+            value *= 16777619u;
+        }
+        return value;
+    }
+
+    static constexpr uint32_t offsetBasis = 2166136261u;
+
+private:
+    uint32_t hash_;
+
+    static constexpr UniformId fromHash(uint32_t value) {
+        UniformId id("");
+        id.hash_ = value;
+        return id;
+    }
+};
+
+constexpr UniformId operator""_u(const char* name, size_t length) {
+    return UniformId(std::string_view(name, length));
+}
+
+/**
+ * Name -> location map of a linked program's active uniforms.
+ *
+ * Open addressing with linear probing over one flat array, so a lookup is a hash, a few
+ * neighbouring slots and a name compare, with no allocation and no GL call.
+ * Lookups by UniformId compare hashes only, see shadowedByHash for detecting collisions.
+ */
+class UniformTable {
+public:
+    static constexpr uint32_t hash(std::string_view name) {
+        return UniformId(name).hash();
+    }
+
+    void insert(std::string_view name, GLint location) {
+        // keep the load factor at or below 1/2 so probe sequences stay short
+        if ((size_ + 1) * 2 > entries_.size()) {
+            rehash(entries_.empty() ? 16 : entries_.size() * 2);
+        }
+
+        uint32_t nameHash = hash(name);
+        Entry& entry = entries_[slotOf(name, nameHash)];
+        if (entry.name.empty()) {
+            entry.name = name;
+            entry.hash = nameHash;
+            size_++;
+        }
+        entry.location = location;
+    }
+
+    // -1 (what glGetUniformLocation returns) if the program has no such active uniform
+    GLint find(std::string_view name) const {
+        if (entries_.empty()) {
+            return -1;
+        }
+        const Entry& entry = entries_[slotOf(name, hash(name))];
+        return entry.name.empty() ? -1 : entry.location;
+    }
+
+    // -1 if no active uniform has the id's hash
+    GLint find(UniformId id) const {
+        if (entries_.empty()) {
+            return -1;
+        }
+        size_t mask = entries_.size() - 1;
+        size_t slot = id.hash() & mask;
+        while (!entries_[slot].name.empty()) {
+            if (entries_[slot].hash == id.hash()) {
+                return entries_[slot].location;
+            }
+            slot = (slot + 1) & mask;
+        }
+        return -1;
+    }
+
+    /**
+     * True if a lookup by name's hash finds a different uniform, i.e. name collides with
+     * a uniform probed before it and can only be set by its full name.
+     * @precondition name was inserted
+     */
+    bool shadowedByHash(std::string_view name) const {
+        uint32_t nameHash = hash(name);
+        size_t mask = entries_.size() - 1;
+        size_t slot = nameHash & mask;
+        while (entries_[slot].name.empty() || entries_[slot].hash != nameHash) {
+            slot = (slot + 1) & mask;
+        }
+        return entries_[slot].name != name;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    void clear() {
+        entries_.clear();
+        size_ = 0;
+    }
+
+private:
+    struct Entry {
+        // empty for an unused slot, uniform names never are
+        std::string name;
+        uint32_t hash = 0;
+        GLint location = -1;
+    };
+
+    std::vector<Entry> entries_;
+    size_t size_ = 0;
+
+    // slot holding name, or the empty slot it would be inserted into
+    size_t slotOf(std::string_view name, uint32_t nameHash) const {
+        size_t mask = entries_.size() - 1;
+        size_t slot = nameHash & mask;
+        while (!entries_[slot].name.empty() && (entries_[slot].hash != nameHash || entries_[slot].name != name)) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    // @precondition capacity is a power of two above twice the size
+    void rehash(size_t capacity) {
+        std::vector<Entry> old;
+        old.swap(entries_);
+        entries_.resize(capacity);
+        for (Entry& entry : old) {
+            if (!entry.name.empty()) {
+                size_t slot = slotOf(entry.name, entry.hash);
+                entries_[slot] = std::move(entry);
+            }
+        }
+    }
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include <glad/glad.h>
+
+struct VertexAttribute {
+    GLuint location;
+    GLint components;
+    GLenum type;
+    // integer types are normalized to [0, 1] (unsigned) or [-1, 1] (signed)
+    GLboolean normalized;
+    size_t offset;
+};
+
+/**
+ * Compile-time description of a vertex struct, specialised next to each vertex type:
+ *
+ *   template <>
+ *   struct VertexLayout<MyVertex> {
+ *       static constexpr std::array<VertexAttribute, 1> attributes = {{
+ *           {0, 3, GL_FLOAT, GL_FALSE, offsetof(MyVertex, position)}
+ *       }};
+ *   };
+ *
+ * The attribute locations must match the layout qualifiers of the vertex shaders used with it.
+ */
+template <typename VertexT>
+struct VertexLayout;
+
+/**
+ * Enables and points every attribute of VertexT at the currently bound GL_ARRAY_BUFFER.
+ * baseOffset is the byte offset of the first vertex in that buffer.
+ */
+template <typename VertexT>
+void setupVertexAttributes(size_t baseOffset = 0) {
+    for (const VertexAttribute& attribute : VertexLayout<VertexT>::attributes) {
+        glEnableVertexAttribArray(attribute.location);
+        glVertexAttribPointer(
+            attribute.location, attribute.components, attribute.type, attribute.normalized,
+            sizeof(VertexT), reinterpret_cast<const void*>(baseOffset + attribute.offset)
+        );
+    }
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include "vertex_layout.h"
+
+/**
+ * Compact 16 byte vertex, half the size of Vertex:
+ *   position:  unorm16 relative to the mesh bounds (w is padding)
+ *   normal:    octahedral encoding, snorm16
+ *   texCoords: half floats, so tiling coordinates outside [0, 1] still work
+ * Decoded in quantized_vertex.glsl, which needs the bounds as positionOffset/positionScale uniforms.
+ */
+struct QuantizedVertex {
+    uint16_t position[4];
+    int16_t normal[2];
+    uint16_t texCoords[2];
+};
+
+static_assert(sizeof(QuantizedVertex) == 16, "QuantizedVertex must stay tightly packed");
+
+template <>
+struct VertexLayout<QuantizedVertex> {
+    static constexpr std::array<VertexAttribute, 3> attributes = {{
+        {0, 3, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(QuantizedVertex, position)},
+        {1, 2, GL_SHORT, GL_TRUE, offsetof(QuantizedVertex, normal)},
+        {2, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(QuantizedVertex, texCoords)}
+    }};
+};
+
+/**
+ * Axis aligned bounds the positions are quantized in, position = offset + scale * unorm.
+ */
+struct PositionBounds {
+    glm::vec3 offset{0.0f};
+    glm::vec3 scale{1.0f};
+};
+
+namespace VertexQuantization {
+
+    inline glm::vec2 signNotZero(glm::vec2 v) {
+        return glm::vec2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+    }
+
+    /**
+     * Maps a unit vector onto the [-1, 1] square by projecting onto the octahedron and folding the lower half.
+     */
+    inline glm::vec2 octEncode(glm::vec3 normal) {
+        normal /= std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+        glm::vec2 encoded(normal.x, normal.y);
+        if (normal.z < 0.0f) {
+            encoded = (1.0f - glm::abs(glm::vec2(encoded.y, encoded.x))) * signNotZero(encoded);
+        }
+        return encoded;
+    }
+
+    // must match octDecode in quantized_vertex.glsl
+    inline glm::vec3 octDecode(glm::vec2 encoded) {
+        glm::vec3 normal(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+        if (normal.z < 0.0f) {
+            glm::vec2 folded = (1.0f - glm::abs(glm::vec2(normal.y, normal.x))) * signNotZero(glm::vec2(normal));
+            normal.x = folded.x;
+            normal.y = folded.y;
+        }
+        return glm::normalize(normal);
+    }
+
+    template <typename VertexT>
+    PositionBounds computeBounds(const VertexT* vertices, size_t vertexCount) {
+        if (vertexCount == 0) {
+            return PositionBounds();
+        }
+
+        glm::vec3 min = vertices[0].position;
+        glm::vec3 max = vertices[0].position;
+        for (size_t i = 1; i < vertexCount; i++) {
+            min = glm::min(min, vertices[i].position);
+            max = glm::max(max, vertices[i].position);
+        }
+
+        PositionBounds bounds;
+        bounds.offset = min;
+        // flat axes keep a non zero scale so encoding never divides by zero
+        bounds.scale = glm::max(max - min, glm::vec3(1e-20f));
+        return bounds;
+    }
+
+    template <typename VertexT>
+    QuantizedVertex encode(const VertexT& vertex, const PositionBounds& bounds) {
+        QuantizedVertex quantized;
+
+        glm::vec3 relative = (vertex.position - bounds.offset) / bounds.scale;
+        for (int i = 0; i < 3; i++) {
+            quantized.position[i] = glm::packUnorm1x16(relative[i]);
+        }
+        quantized.position[3] = 0;
+
+        glm::vec2 normal = octEncode(vertex.normal);
+        quantized.normal[0] = static_cast<int16_t>(glm::packSnorm1x16(normal.x));
+        quantized.normal[1] = static_cast<int16_t>(glm::packSnorm1x16(normal.y));
+
+        quantized.texCoords[0] = glm::packHalf1x16(vertex.texCoords.x);
+        quantized.texCoords[1] = glm::packHalf1x16(vertex.texCoords.y);
+        return quantized;
+    }
+
+    /**
+     * CPU reference of the shader side decode, returns the attributes as the vertex shader sees them.
+     */
+    template <typename VertexT>
+    VertexT decode(const QuantizedVertex& quantized, const PositionBounds& bounds) {
+        VertexT vertex;
+        for (int i = 0; i < 3; i++) {
+            vertex.position[i] = bounds.offset[i] + bounds.scale[i] * glm::unpackUnorm1x16(quantized.position[i]);
+        }
+
+        vertex.normal = octDecode(glm::vec2(
+            glm::unpackSnorm1x16(static_cast<uint16_t>(quantized.normal[0])),
+            glm::unpackSnorm1x16(static_cast<uint16_t>(quantized.normal[1]))
+        ));
+
+        vertex.texCoords = glm::vec2(
+            glm::unpackHalf1x16(quantized.texCoords[0]),
+            glm::unpackHalf1x16(quantized.texCoords[1])
+        );
+        return vertex;
+    }
+
+    template <typename VertexT>
+    std::vector<QuantizedVertex> quantize(const VertexT* vertices, size_t vertexCount, const PositionBounds& bounds) {
+        std::vector<QuantizedVertex> quantized(vertexCount);
+        for (size_t i = 0; i < vertexCount; i++) {
+            quantized[i] = encode(vertices[i], bounds);
+        }
+        return quantized;
+    }
+
+    // upper bound of the per axis position error of an encode/decode round trip: half a quantization step
+    // with some headroom, plus the float rounding of the encode and decode arithmetic, which grows with the
+    // magnitude of the positions and dominates for small meshes far from the origin
+    inline glm::vec3 maxPositionError(const PositionBounds& bounds) {
+        return bounds.scale * (0.6f / 65535.0f)
+            + (glm::abs(bounds.offset) + bounds.scale) * (4.0f * std::numeric_limits<float>::epsilon());
+    }
+
+}
@@ -5,10 +5,10 @@ layout (location = 1) in vec2 aTexCoords;
 out vec2 TexCoords;
 
 uniform mat4 model;
-uniform mat4 viewProj;
+#include "frame_block.glsl"
 
 void main()
 {
     TexCoords = aTexCoords;    
-    gl_Position = viewProj * model * vec4(aPos, 1.0);
+    gl_Position = viewProjection * model * vec4(aPos, 1.0);
 }
\ No newline at end of file
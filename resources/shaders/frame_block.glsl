@@ -0,0 +1,5 @@
+// per frame camera state, see FrameBlock in include/uniform_blocks.h
+layout (std140) uniform Frame {
+    mat4 viewProjection;
+    vec3 viewPosition;
+};
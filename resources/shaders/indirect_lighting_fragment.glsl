@@ -0,0 +1,41 @@
+#version 430 core
+
+// must match Model::indirectBatchTextures, which the demo injects
+#ifndef BATCH_TEXTURES
+#define BATCH_TEXTURES 8
+#endif
+
+out vec4 FragColor;
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+flat in ivec2 MaterialMaps;
+
+// the batch's textures, indexed by the per draw MaterialMaps slots
+layout (binding = 0) uniform sampler2D diffuseMaps[BATCH_TEXTURES];
+layout (binding = BATCH_TEXTURES) uniform sampler2D specularMaps[BATCH_TEXTURES];
+uniform float shininess;
+
+// the slot is the same for every fragment of a draw, so the sampler array index is dynamically uniform
+vec3 diffuseColor() {
+    return MaterialMaps.x < 0 ? vec3(0.0) : vec3(texture(diffuseMaps[MaterialMaps.x], TexCoords));
+}
+
+vec3 specularColor() {
+    return MaterialMaps.y < 0 ? vec3(0.0) : vec3(texture(specularMaps[MaterialMaps.y], TexCoords));
+}
+
+float materialShininess() {
+    return shininess;
+}
+
+// lights and permutation defines (POINT_LIGHT_COUNT, DIRECTIONAL_LIGHT, SPOT_LIGHT, HAS_SPECULAR_MAP)
+#include "lighting_common.glsl"
+
+void main() {
+    vec3 normal = normalize(Normal);
+    vec3 viewDirection = normalize(viewPosition - FragPos);
+
+    FragColor = vec4(calcLighting(normal, FragPos, viewDirection), 1.0);
+}
@@ -0,0 +1,34 @@
+#version 430 core
+#extension GL_ARB_shader_draw_parameters : require
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+out vec3 Normal;
+out vec3 FragPos;
+out vec2 TexCoords;
+// diffuse and specular sampler slot of this draw, -1 if the mesh has none
+flat out ivec2 MaterialMaps;
+
+// per draw material slots of the whole model, see Model::drawIndirect
+layout (std430, binding = 0) readonly buffer DrawMaterials {
+    ivec2 drawMaterials[];
+};
+
+uniform mat4 model;
+uniform mat3 normalMatrix;
+#include "frame_block.glsl"
+
+// index of the batch's first draw in drawMaterials, gl_DrawIDARB restarts at 0 every call
+uniform int firstDraw;
+
+void main() {
+    vec4 worldPos = model * vec4(aPos, 1.0);
+    gl_Position = viewProjection * worldPos;
+
+    Normal = normalMatrix * aNormal;
+    FragPos = vec3(worldPos);
+    TexCoords = aTexCoords;
+    MaterialMaps = drawMaterials[firstDraw + gl_DrawIDARB];
+}
@@ -0,0 +1,160 @@
+// Lights block, light structs and the lighting model shared by the lit fragment shaders.
+//
+// The including shader declares vec3 diffuseColor(), vec3 specularColor() and float materialShininess() first.
+// Permutation defines, injected by the Shader preprocessor, pick the work done per fragment:
+//   POINT_LIGHT_COUNT  point lights evaluated, at most MAX_POINT_LIGHTS (default: all of them)
+//   DIRECTIONAL_LIGHT  0 drops the directional light (default 1)
+//   SPOT_LIGHT         0 drops the spot light (default 1)
+//   HAS_SPECULAR_MAP   0 drops the specular term (default 1)
+
+#include "frame_block.glsl"
+
+// must match LightsBlock::pointLightCount, the block layout doesn't depend on the permutation
+#define MAX_POINT_LIGHTS 4
+
+#ifndef POINT_LIGHT_COUNT
+#define POINT_LIGHT_COUNT MAX_POINT_LIGHTS
+#endif
+#ifndef DIRECTIONAL_LIGHT
+#define DIRECTIONAL_LIGHT 1
+#endif
+#ifndef SPOT_LIGHT
+#define SPOT_LIGHT 1
+#endif
+#ifndef HAS_SPECULAR_MAP
+#define HAS_SPECULAR_MAP 1
+#endif
+
+#if POINT_LIGHT_COUNT > MAX_POINT_LIGHTS
+#error POINT_LIGHT_COUNT exceeds MAX_POINT_LIGHTS
+#endif
+
+struct DirectionalLight {
+    vec3 direction;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct PointLight {
+    vec3 position;
+
+    float constant;
+    float linear;
+    float quadratic;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+    float innerCutOff;
+    float outerCutOff;
+
+    float constant;
+    float linear;
+    float quadratic;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+// the full light set, see LightsBlock in include/uniform_blocks.h
+layout (std140) uniform Lights {
+    DirectionalLight dirLight;
+    PointLight pointLights[MAX_POINT_LIGHTS];
+    SpotLight spotLight;
+};
+
+float calcAttenuation(float constant, float linear, float quadratic, float distance) {
+    float denom = constant + linear * distance + quadratic * distance * distance;
+    return 1 / denom;
+}
+
+float calcIntensity(float theta, float innerCutOff, float outerCutOff) {
+    float epsilon = innerCutOff - outerCutOff;
+    return clamp((theta - outerCutOff) / epsilon, 0.0, 1.0);
+}
+
+vec3 calcAmbient(vec3 lightAmbient) {
+    return lightAmbient * diffuseColor();
+}
+
+vec3 calcDiffuse(vec3 lightDiffuse, vec3 normal, vec3 lightDir) {
+    float diff = max(dot(normal, lightDir), 0.0);
+    return lightDiffuse * diff * diffuseColor();
+}
+
+vec3 calcSpecular(vec3 lightSpecular, vec3 normal, vec3 lightDir, vec3 viewDir) {
+#if HAS_SPECULAR_MAP
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), materialShininess());
+    return lightSpecular * spec * specularColor();
+#else
+    return vec3(0.0);
+#endif
+}
+
+vec3 calcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir) {
+    vec3 lightDir = normalize(-light.direction);
+
+    vec3 ambient = calcAmbient(light.ambient); 
+    vec3 diffuse = calcDiffuse(light.diffuse, normal, lightDir);
+    vec3 specular = calcSpecular(light.specular, normal, lightDir, viewDir); 
+    return (ambient + diffuse + specular);
+}
+
+vec3 calcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
+    vec3 lightDir = normalize(light.position - fragPos);
+    float distance = length(light.position - fragPos);
+
+    float attenuation = calcAttenuation(
+        light.constant, light.linear, light.quadratic, distance
+    );
+
+    vec3 ambient = calcAmbient(light.ambient); 
+    vec3 diffuse = calcDiffuse(light.diffuse, normal, lightDir);
+    vec3 specular = calcSpecular(light.specular, normal, lightDir, viewDir); 
+    return (ambient + diffuse + specular) * attenuation;
+}
+
+vec3 calcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
+    vec3 lightDir = normalize(light.position - fragPos);
+    float distance = length(light.position - fragPos);
+
+    float attenuation = calcAttenuation(
+        light.constant, light.linear, light.quadratic, distance
+    );
+
+    float theta = dot(lightDir, normalize(-light.direction));
+    float intensity = calcIntensity(theta, light.innerCutOff, light.outerCutOff);
+
+    vec3 ambient = calcAmbient(light.ambient); 
+    vec3 diffuse = calcDiffuse(light.diffuse, normal, lightDir);
+    vec3 specular = calcSpecular(light.specular, normal, lightDir, viewDir); 
+    return ambient + ((diffuse + specular) * attenuation * intensity);
+}
+
+// every light the permutation includes
+vec3 calcLighting(vec3 normal, vec3 fragPos, vec3 viewDir) {
+    vec3 result = vec3(0.0);
+
+#if DIRECTIONAL_LIGHT
+    result += calcDirectionalLight(dirLight, normal, viewDir);
+#endif
+
+    for (int i = 0; i < POINT_LIGHT_COUNT; i++) {
+        result += calcPointLight(pointLights[i], normal, fragPos, viewDir);
+    }
+
+#if SPOT_LIGHT
+    result += calcSpotLight(spotLight, normal, fragPos, viewDir);
+#endif
+
+    return result;
+}
@@ -1,5 +1,13 @@
 #version 330 core
 
+// the light's type is a permutation define instead of a uniform, see ShaderDefines
+#define LIGHT_POINT 1
+#define LIGHT_DIRECTIONAL 2
+#define LIGHT_SPOT 3
+#ifndef LIGHT_TYPE
+#define LIGHT_TYPE LIGHT_POINT
+#endif
+
 out vec4 FragColor;
 
 in vec3 FragPos;
@@ -18,11 +26,6 @@ struct Light {
     float innerCutOff;
     float outerCutOff;
 
-    int type;
-    // 1 => point source
-    // 2 => directional source
-    // 3 => spotlight source
-
     vec3 ambient;
     vec3 diffuse;
     vec3 specular;
@@ -46,28 +49,23 @@ void main() {
     float attenuation = 1.0; // no attenuation
     float intensity = 1.0;
 
-    // point source
-    if (light.type == 1) {
-        lightDir = light.position - FragPos;
-        attenuation = calculateAttenuation(length(lightDir));
-        lightDir = normalize(lightDir);
-    }
-
-    // directional source
-    if (light.type == 2) {
-        lightDir = normalize(-light.direction);
-    }
-
-    // spotlight source
-    if (light.type == 3) {
-        lightDir = light.position - FragPos;
-        attenuation = calculateAttenuation(length(lightDir));
-        lightDir = normalize(lightDir);
-        
-        float theta = dot(lightDir, normalize(-light.direction));
-        float epsilon = light.innerCutOff - light.outerCutOff;
-        intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
-    }
+#if LIGHT_TYPE == LIGHT_POINT
+    lightDir = light.position - FragPos;
+    attenuation = calculateAttenuation(length(lightDir));
+    lightDir = normalize(lightDir);
+#elif LIGHT_TYPE == LIGHT_DIRECTIONAL
+    lightDir = normalize(-light.direction);
+#elif LIGHT_TYPE == LIGHT_SPOT
+    lightDir = light.position - FragPos;
+    attenuation = calculateAttenuation(length(lightDir));
+    lightDir = normalize(lightDir);
+    
+    float theta = dot(lightDir, normalize(-light.direction));
+    float epsilon = light.innerCutOff - light.outerCutOff;
+    intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+#else
+#error unknown LIGHT_TYPE
+#endif
 
     // ambient 
     vec3 ambient = vec3(texture(material.diffuse, TexCoords)) * light.ambient;
@@ -83,13 +81,11 @@ void main() {
     float specularCoeff = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
     vec3 specular = specularCoeff * vec3(texture(material.specular, TexCoords)) * light.specular;
 
-    vec3 result;
-    
-    if (light.type == 3) {
-        result = ambient + ((diffuse + specular) * attenuation * intensity);
-    } else {
-        result = (ambient + diffuse + specular) * attenuation;
-    }
+#if LIGHT_TYPE == LIGHT_SPOT
+    vec3 result = ambient + ((diffuse + specular) * attenuation * intensity);
+#else
+    vec3 result = (ambient + diffuse + specular) * attenuation;
+#endif
 
     FragColor = vec4(result, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,40 @@
+#version 330 core
+
+// QuantizedVertex, see include/vertex_quantization.h
+layout (location = 0) in vec3 aPos;       // unorm16, relative to the mesh bounds
+layout (location = 1) in vec2 aNormal;    // octahedral, snorm16
+layout (location = 2) in vec2 aTexCoords; // half float
+
+out vec3 Normal;
+out vec3 FragPos;
+out vec2 TexCoords;
+
+uniform mat4 model;
+uniform mat3 normalMatrix;
+#include "frame_block.glsl"
+
+// mesh bounds the positions were quantized in
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+
+vec2 signNotZero(vec2 v) {
+    return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+vec3 octDecode(vec2 encoded) {
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    if (normal.z < 0.0) {
+        normal.xy = (1.0 - abs(normal.yx)) * signNotZero(normal.xy);
+    }
+    return normalize(normal);
+}
+
+void main() {
+    vec3 position = positionOffset + positionScale * aPos;
+    vec4 worldPos = model * vec4(position, 1.0);
+    gl_Position = viewProjection * worldPos;
+
+    Normal = normalMatrix * octDecode(aNormal);
+    FragPos = vec3(worldPos);
+    TexCoords = aTexCoords;
+}
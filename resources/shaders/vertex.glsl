@@ -10,7 +10,7 @@ out vec2 TexCoords;
 
 uniform mat4 model;
 uniform mat3 normalMatrix;
-uniform mat4 viewProjection;
+#include "frame_block.glsl"
 
 void main() {
     vec4 worldPos = model * vec4(aPos, 1.0);
@@ -8,17 +8,33 @@
 
 #include <shader.h>
 #include <camera.h>
+#include <camera_path.h>
+#include <fixed_timestep.h>
+#include <gl_extensions.h>
+#include <input_latency.h>
 #include <model.h>
+#include <texture_loader.h>
+#include <texture_registry.h>
+#include <uniform_blocks.h>
+#include <uniform_buffer.h>
 
 #include <iostream>
 #include <map>
+#include <memory>
+#include <string>
+
+// calls glfwTerminate when main returns, after the locals declared later have been destroyed
+struct GlfwSession {
+    ~GlfwSession() { glfwTerminate(); }
+};
 
 void errorExit(std::string msg, int errorReturn = 1);
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
-void processInput(GLFWwindow *window);
-unsigned int loadTexture(const std::string& fileName);
-unsigned int loadCubeMap(const std::string& fileDirectory, const std::string& fileSuffix);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+CameraMovement processInput(GLFWwindow *window);
+TextureHandle loadTexture(const std::string& fileName);
+TextureHandle loadCubeMap(const std::string& fileDirectory, const std::string& fileSuffix);
 
 // settings
 unsigned int SCR_WIDTH = 800;
@@ -30,13 +46,44 @@ float lastX = (float)SCR_WIDTH  / 2.0;
 float lastY = (float)SCR_HEIGHT / 2.0;
 bool firstMouse = true;
 
-// timing
+// --record-path logs the camera to this file, --play-path flies it along one instead of following input
+std::string recordPathFile;
+std::string playPathFile;
+bool playingCameraPath = false;
+// --late-latch polls input again right before the main pass, --measure-latency reports input to swap latency
+bool lateLatch = false;
+bool measureLatency = false;
+InputLatencyTracker inputLatency;
+
+// timing, deltaTime is the real time of the last frame, the simulation runs at a fixed timestep
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
-int main()
+// texture streaming, bytes of decoded image data uploaded per frame
+const size_t textureUploadBudget = 16 * 1024 * 1024;
+
+int main(int argc, char* argv[])
 {
+    // argument handling
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--record-path" && i + 1 < argc) {
+            recordPathFile = argv[++i];
+        } else if (arg == "--play-path" && i + 1 < argc) {
+            playPathFile = argv[++i];
+        } else if (arg == "--late-latch") {
+            lateLatch = true;
+        } else if (arg == "--measure-latency") {
+            measureLatency = true;
+        } else {
+            std::cout << "Incorrect Program usage" << std::endl;
+            exit(1);
+        }
+    }
+
     glfwInit();
+    // terminates GLFW after every GL object owner declared below has released its objects
+    GlfwSession glfwSession;
 
     // gets the width and height of the primary monitor
     GLFWmonitor* primary = glfwGetPrimaryMonitor();
@@ -62,13 +109,20 @@ int main()
     glfwMakeContextCurrent(window);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetKeyCallback(window, key_callback);
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);  
+    // unaccelerated, unscaled mouse motion, it reaches the camera without the OS pointer processing
+    if (lateLatch && glfwRawMouseMotionSupported()) {
+        glfwSetInputMode(window, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
+    }
 
     // glad: load all OpenGL function pointers
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
     {
         errorExit("Failed to initialize GLAD", -1);
     }
+    // optional features, parallelShaderCompile lets the shader builds submitted below run on driver threads
+    GLExtensions::load((GLADloadproc)glfwGetProcAddress);
 
     // configure global opengl state
     glEnable(GL_DEPTH_TEST);
@@ -78,11 +132,22 @@ int main()
     glStencilMask(0x00); // disable writing to stencil mask as default
     glEnable(GL_CULL_FACE);
 
-    // build and compile shaders
-    Shader shader("depth_testing.vs", "depth_testing.fs");
-    Shader outlineShader("depth_testing.vs", "stencil_outline.fs");
-    Shader screenShader("framebuffer_vert.glsl", "framebuffer_frag.glsl");
-    Shader skyboxShader("skybox.vs", "skybox.fs");
+    // submit every shader build up front, the driver compiles them while the buffers and textures load
+    Shader shader = Shader::submit("depth_testing.vs", "depth_testing.fs");
+    Shader outlineShader = Shader::submit("depth_testing.vs", "stencil_outline.fs");
+    Shader screenShader = Shader::submit("framebuffer_vert.glsl", "framebuffer_frag.glsl");
+    Shader skyboxShader = Shader::submit("skybox.vs", "skybox.fs");
+
+    // the view projection matrix, uploaded once per frame for both depth_testing.vs programs
+    UniformBuffer<FrameBlock> frameUniforms;
+    shader.onReady([](Shader& program) {
+        program.bindUniformBlock(FrameBlock::blockName, FrameBlock::binding);
+        program.use();
+        program.setInt("texture1", 0);
+    });
+    outlineShader.onReady([](Shader& program) {
+        program.bindUniformBlock(FrameBlock::blockName, FrameBlock::binding);
+    });
 
     // set up vertex data (and buffer(s)) and configure vertex attributes
     float cubeVertices[] = {
@@ -246,15 +311,11 @@ int main()
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // load textures
-    unsigned int cubeTexture  = loadTexture("container.jpg");
-    unsigned int floorTexture = loadTexture("metal.png");
-    unsigned int vegitationTexture = loadTexture("grass.png");
-    unsigned int windowTexture = loadTexture("window.png");
-    unsigned int skyboxTexture = loadCubeMap("skybox", ".jpg");
-
-    // shader configuration
-    shader.use();
-    shader.setInt("texture1", 0);
+    TextureHandle cubeTexture  = loadTexture("container.jpg");
+    TextureHandle floorTexture = loadTexture("metal.png");
+    TextureHandle vegitationTexture = loadTexture("grass.png");
+    TextureHandle windowTexture = loadTexture("window.png");
+    TextureHandle skyboxTexture = loadCubeMap("skybox", ".jpg");
 
     // cube positions
     std::vector<glm::vec3> cubes{
@@ -271,6 +332,27 @@ int main()
     };
     std::vector<glm::vec3> windows = vegitation;
 
+    // camera path recording or playback
+    std::unique_ptr<CameraPathPlayback> pathPlayback;
+    if (!playPathFile.empty()) {
+        CameraPath path;
+        if (!path.load(playPathFile)) errorExit("Failed to load camera path", -1);
+        pathPlayback = std::make_unique<CameraPathPlayback>(std::move(path));
+        playingCameraPath = true;
+        // frames aren't held back to the refresh rate, so the frame times measure the rendering
+        glfwSwapInterval(0);
+    }
+    CameraPathRecorder pathRecorder;
+    if (!recordPathFile.empty() && !pathRecorder.open(recordPathFile)) {
+        errorExit("Failed to record camera path", -1);
+    }
+
+    // camera movement is simulated at a fixed timestep, frames are rendered between the last two steps
+    FixedTimestep simulation;
+    Interpolated<glm::vec3> cameraPosition(camera.getPosition());
+    // the camera frames are rendered from, looking where the simulated camera looks now
+    Camera viewCamera = camera;
+
     // render loop
     while(!glfwWindowShouldClose(window)) {
         // per-frame time logic
@@ -278,9 +360,35 @@ int main()
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
-        // input
-        processInput(window);
+        // input, a camera path replaces the camera movement and runs at its fixed timestep
+        CameraMovement cameraMovement = processInput(window);
+        if (pathPlayback) {
+            if (!pathPlayback->advance(camera)) {
+                pathPlayback->printReport("depth testing");
+                break;
+            }
+            deltaTime = pathPlayback->timestep();
+            // the path places the camera, there is nothing to interpolate
+            cameraPosition = Interpolated<glm::vec3>(camera.getPosition());
+        }
 
+        // simulation
+        int steps = simulation.advance(deltaTime);
+        for (int step = 0; step < steps; step++) {
+            cameraPosition.beginStep();
+            if (!playingCameraPath) {
+                camera.move(cameraMovement, simulation.step());
+            }
+            cameraPosition.current = camera.getPosition();
+        }
+        // the simulated pose, at the time it was simulated to, frames without a step have nothing new to record
+        if (steps > 0) {
+            pathRecorder.record(simulation.simulatedTime(), camera);
+        }
+        viewCamera.setPose(CameraPose{cameraPosition.at(simulation.alpha()), camera.getYaw(), camera.getPitch()});
+
+        // upload textures that finished decoding
+        TextureLoader::shared().uploadPending(textureUploadBudget);
 
         // render everything to custom frame buffer
         glBindFramebuffer(GL_FRAMEBUFFER, FBO);
@@ -290,109 +398,141 @@ int main()
         glEnable(GL_DEPTH_TEST);
         glStencilMask(0x00); // disable writing to stencil buffer again
 
+        // late latch: handle the input that arrived during this frame's CPU work, so the view the main pass is
+        // drawn with is as fresh as possible. Mouse look applies straight away, movement stays with the simulation
+        if (lateLatch) {
+            glfwPollEvents();
+            viewCamera.setPose(CameraPose{viewCamera.getPosition(), camera.getYaw(), camera.getPitch()});
+        }
+
         // initial setup
         float aspectRatio = (float)SCR_WIDTH / (float)SCR_HEIGHT;
-        glm::mat4 viewProj = camera.getViewProjectionMatrix(aspectRatio);
-        shader.use();
-        shader.setMat4("viewProj", viewProj);
-        outlineShader.use();
-        outlineShader.setMat4("viewProj", viewProj);
-
+        frameUniforms.data().viewProjection = viewCamera.getViewProjectionMatrix(aspectRatio);
+        // objects entirely outside the view aren't drawn, bounded by spheres around the unit cube and quad
+        Frustum frustum = Frustum::fromViewProjection(frameUniforms.data().viewProjection);
+        const float cubeBoundsRadius = 0.5f * glm::sqrt(3.0f);
+        const float quadBoundsRadius = 0.5f * glm::sqrt(2.0f);
+        frameUniforms.data().viewPosition = viewCamera.getPosition();
+        frameUniforms.upload();
+
+        // passes whose program is still building are skipped until it has linked
         // floor
-        shader.use();
-        glDisable(GL_CULL_FACE);
-        glBindVertexArray(planeVAO);
-        glBindTexture(GL_TEXTURE_2D, floorTexture);
-        shader.setMat4("model", glm::mat4(1.0f));
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        glBindVertexArray(0);
-        glEnable(GL_CULL_FACE);
+        if (shader.isReady()) {
+            shader.use();
+            glDisable(GL_CULL_FACE);
+            glBindVertexArray(planeVAO);
+            glBindTexture(GL_TEXTURE_2D, floorTexture->id);
+            shader.setMat4("model", glm::mat4(1.0f));
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+            glBindVertexArray(0);
+            glEnable(GL_CULL_FACE);
+        }
 
         // cubes
-        shader.use();
-        glBindVertexArray(cubeVAO);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, cubeTexture);
-        for (auto cubePos : cubes) {
-            glStencilMask(0x01); // enable writing to only the first bit of the stencil buffer
-            glStencilFunc(GL_ALWAYS, 0x01, 0x01); // for every fragment we render, set the first bit in the stencil
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), cubePos);
-            shader.setMat4("model", model);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-            glStencilMask(0x00); // disable writing to the stencil buffer
+        if (shader.isReady()) {
+            shader.use();
+            glBindVertexArray(cubeVAO);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, cubeTexture->id);
+            for (auto cubePos : cubes) {
+                if (!frustum.intersectsSphere(cubePos, cubeBoundsRadius)) {
+                    continue;
+                }
+                glStencilMask(0x01); // enable writing to only the first bit of the stencil buffer
+                glStencilFunc(GL_ALWAYS, 0x01, 0x01); // for every fragment we render, set the first bit in the stencil
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), cubePos);
+                shader.setMat4("model", model);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+                glStencilMask(0x00); // disable writing to the stencil buffer
+            }
         }
 
         // render skybox as late as possible (but before transparent objects)
-        glDisable(GL_CULL_FACE);
-        glDepthFunc(GL_LEQUAL);
-        skyboxShader.use();
-        glm::mat4 skyboxView = glm::mat4(glm::mat3(camera.getViewMatrix()));
-        glm::mat4 skyboxViewProj = camera.getProjectionMatrix(aspectRatio) * skyboxView;
-        skyboxShader.setMat4("viewProj", skyboxViewProj);
-        glBindVertexArray(cubeVAO);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxTexture);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-        glDepthFunc(GL_LESS);
-        glEnable(GL_CULL_FACE);
+        if (skyboxShader.isReady()) {
+            glDisable(GL_CULL_FACE);
+            glDepthFunc(GL_LEQUAL);
+            skyboxShader.use();
+            glm::mat4 skyboxView = glm::mat4(glm::mat3(viewCamera.getViewMatrix()));
+            glm::mat4 skyboxViewProj = viewCamera.getProjectionMatrix(aspectRatio) * skyboxView;
+            skyboxShader.setMat4("viewProj", skyboxViewProj);
+            glBindVertexArray(cubeVAO);
+            glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxTexture->id);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+            glDepthFunc(GL_LESS);
+            glEnable(GL_CULL_FACE);
+        }
 
         // windows
-        shader.use();
-        glDisable(GL_CULL_FACE);
-        glBindVertexArray(quadVAO);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, windowTexture);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        std::map<float, glm::vec3> sortedWindows;
-        for (auto windowPos : windows) {
-            float distance = glm::length(camera.getPosition() - windowPos);
-            sortedWindows[-distance] = windowPos;
-        }
-        for (auto sortedWindow : sortedWindows) {
-            glm::vec3 windowPos = sortedWindow.second;
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), windowPos);
-            shader.setMat4("model", model);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
+        if (shader.isReady()) {
+            shader.use();
+            glDisable(GL_CULL_FACE);
+            glBindVertexArray(quadVAO);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, windowTexture->id);
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            std::map<float, glm::vec3> sortedWindows;
+            for (auto windowPos : windows) {
+                // the quad spans x = 0..1 from its position
+                if (!frustum.intersectsSphere(windowPos + glm::vec3(0.5f, 0.0f, 0.0f), quadBoundsRadius)) {
+                    continue;
+                }
+                float distance = glm::length(viewCamera.getPosition() - windowPos);
+                sortedWindows[-distance] = windowPos;
+            }
+            for (auto sortedWindow : sortedWindows) {
+                glm::vec3 windowPos = sortedWindow.second;
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), windowPos);
+                shader.setMat4("model", model);
+                glDrawArrays(GL_TRIANGLES, 0, 6);
+            }
+            glDisable(GL_BLEND);
+            glEnable(GL_CULL_FACE);
         }
-        glDisable(GL_BLEND);
-        glEnable(GL_CULL_FACE);
 
         // outline
-        outlineShader.use();
-        glBindVertexArray(cubeVAO);
-        glDisable(GL_DEPTH_TEST);
-        glEnable(GL_BLEND);
-        glDisable(GL_CULL_FACE);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        float outlineScale = 1.05f;
-        for (auto cubePos : cubes) {
-            break;
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), cubePos);
-            model = glm::scale(model, glm::vec3(outlineScale));
-            outlineShader.setMat4("model", model);
-            outlineShader.setVec4("outlineColor", glm::vec4(0.0f, 0.28, 0.26, 1.0));
-            glStencilFunc(GL_NOTEQUAL, 0x01, 0x01); // check if the first bit is set
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+        if (outlineShader.isReady()) {
+            outlineShader.use();
+            glBindVertexArray(cubeVAO);
+            glDisable(GL_DEPTH_TEST);
+            glEnable(GL_BLEND);
+            glDisable(GL_CULL_FACE);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            float outlineScale = 1.05f;
+            for (auto cubePos : cubes) {
+                break;
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), cubePos);
+                model = glm::scale(model, glm::vec3(outlineScale));
+                outlineShader.setMat4("model", model);
+                outlineShader.setVec4("outlineColor", glm::vec4(0.0f, 0.28, 0.26, 1.0));
+                glStencilFunc(GL_NOTEQUAL, 0x01, 0x01); // check if the first bit is set
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+            glEnable(GL_DEPTH_TEST);
+            glEnable(GL_CULL_FACE);
+            glDisable(GL_BLEND);
         }
-        glEnable(GL_DEPTH_TEST);
-        glEnable(GL_CULL_FACE);
-        glDisable(GL_BLEND);
         
         // render to default frame buffer
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
         glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
-        screenShader.use();
-        glBindVertexArray(screenVAO);
-        glDisable(GL_DEPTH_TEST);
-        glDisable(GL_CULL_FACE);
-        glBindTexture(GL_TEXTURE_2D, texColorBuffer);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        glEnable(GL_CULL_FACE);
-        glEnable(GL_DEPTH_TEST);
+        if (screenShader.isReady()) {
+            screenShader.use();
+            glBindVertexArray(screenVAO);
+            glDisable(GL_DEPTH_TEST);
+            glDisable(GL_CULL_FACE);
+            glBindTexture(GL_TEXTURE_2D, texColorBuffer);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+            glEnable(GL_CULL_FACE);
+            glEnable(GL_DEPTH_TEST);
+        }
 
         // swap buffers and poll io events
         glfwSwapBuffers(window);
+        if (measureLatency) {
+            inputLatency.frameSwapped();
+        }
         glfwPollEvents();
     }
 
@@ -404,7 +544,6 @@ int main()
     glDeleteBuffers(1, &planeVBO);
     glDeleteBuffers(1, &quadVBO);
 
-    glfwTerminate();
     return 0;
 }
 
@@ -419,7 +558,8 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
 }
 
-void processInput(GLFWwindow* window) {
+// handles the window keys, returns the camera movement for the simulation
+CameraMovement processInput(GLFWwindow* window) {
     if(glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
         glfwSetWindowShouldClose(window, true);
     }
@@ -445,10 +585,11 @@ void processInput(GLFWwindow* window) {
         cameraMovement.addMovement(MovementDirection::Down);
     }
 
-    camera.move(cameraMovement, deltaTime);
+    return cameraMovement;
 }
 
 void mouse_callback(GLFWwindow* window, double xPos, double yPos) {
+    inputLatency.stampInput();
     static bool firstMouse = true;
     static double lastX, lastY;
 
@@ -465,46 +606,20 @@ void mouse_callback(GLFWwindow* window, double xPos, double yPos) {
     lastX = xPos;
     lastY = yPos;
 
-    camera.rotate(deltaX, -deltaY);
+    if (!playingCameraPath) {
+        camera.rotate(deltaX, -deltaY);
+    }
 }
 
-unsigned int loadTexture(const std::string& fileName) {
-    std::string pathString = "resources/textures/" + fileName;
-    char const *path = pathString.c_str();
-
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-    if (data) {
-        GLint param = GL_REPEAT;
-        GLenum format;
-        if (nrComponents == 1) {
-            format = GL_RED;
-        } else if (nrComponents == 3) {
-            format = GL_RGB;
-        } else if (nrComponents == 4) {
-            format = GL_RGBA;
-            param = GL_CLAMP_TO_EDGE;
-        }
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, param);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, param);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    } else {
-        stbi_image_free(data);
-        errorExit("Texture failed to load at path: " + pathString + "\n");
-    }
+// the keys are read with glfwGetKey, the callback only timestamps the events
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    (void) window; (void) key; (void) scancode; (void) action; (void) mods; // ignore unused variable warnings
+    inputLatency.stampInput();
+}
 
-    return textureID;
+TextureHandle loadTexture(const std::string& fileName) {
+    std::string pathString = "resources/textures/" + fileName;
+    return TextureRegistry::shared().load2D(pathString, false, TextureWrap::ClampToEdgeIfAlpha);
 }
 
 /**
@@ -512,55 +627,17 @@ unsigned int loadTexture(const std::string& fileName) {
  * named after the direction it is in.
  * Also assumes that each texture file has the same file suffix (i.e. all ".jpg").
  */
-unsigned int loadCubeMap(const std::string& fileDirectory, const std::string& fileSuffix) {
+TextureHandle loadCubeMap(const std::string& fileDirectory, const std::string& fileSuffix) {
     std::string dirString = "resources/textures/" + fileDirectory;
 
     const std::vector<std::string> directions = {
         "right", "left", "top", "bottom", "back", "front"
     };
 
-    unsigned int cubeMapID;
-    glGenTextures(1, &cubeMapID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMapID);
-
-    int width, height, nrComponents;
-    int i = 0;
+    std::vector<std::string> facePaths;
     for (auto direction : directions) {
-        std::string pathString = dirString + "/" + direction + fileSuffix;
-        char const* path = pathString.c_str();
-
-        unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-    
-        if (data) {
-            GLint param = GL_REPEAT;
-            GLenum format;
-            if (nrComponents == 1) {
-                format = GL_RED;
-            } else if (nrComponents == 3) {
-                format = GL_RGB;
-            } else if (nrComponents == 4) {
-                format = GL_RGBA;
-                param = GL_CLAMP_TO_EDGE;
-            }
-        
-            glTexImage2D(
-                GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data
-            );
-
-        } else {
-            stbi_image_free(data);
-            errorExit("Texture failed to load at path: " + pathString + "\n");
-        }
-        
-        stbi_image_free(data);
-        i++;
+        facePaths.push_back(dirString + "/" + direction + fileSuffix);
     }
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-    return cubeMapID;
-}
\ No newline at end of file
+
+    return TextureRegistry::shared().loadCubeMap(facePaths);
+}
@@ -1,5 +1,15 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
 #include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -10,52 +20,199 @@
 
 #include "shader.h"
 #include "camera.h"
+#include "camera_path.h"
+#include "fixed_timestep.h"
+#include "input_latency.h"
+#include "frustum.h"
+#include "geometry_arena.h"
+#include "gl_extensions.h"
 #include "model.h"
+#include "program_cache.h"
+#include "shader_files.h"
+#include "shader_permutations.h"
+#include "shader_watcher.h"
+#include "texture_loader.h"
+#include "texture_registry.h"
+#include "uniform_blocks.h"
+#include "uniform_buffer.h"
 
-const char* vertexPath = "./resources/shaders/vertex.glsl";
-const char* textureFragPath = "./resources/shaders/texture_fragment.glsl";
-const char* lightingFragPath = "./resources/shaders/better_lighting_fragment.glsl";
-const char* lightSourceFragPath = "./resources/shaders/light_source_fragment.glsl";
+// shader file names, resolved against resources/shaders/ or the shaders embedded in the executable (see ShaderFiles)
+const char* vertexPath = "vertex.glsl";
+const char* quantizedVertexPath = "quantized_vertex.glsl";
+const char* indirectVertexPath = "indirect_vertex.glsl";
+const char* indirectLightingFragPath = "indirect_lighting_fragment.glsl";
+const char* textureFragPath = "texture_fragment.glsl";
+const char* lightingFragPath = "better_lighting_fragment.glsl";
+const char* lightSourceFragPath = "light_source_fragment.glsl";
 
 const char* containerJPG = "./resources/textures/container.jpg";
 const char* containerMetalPNG = "./resources/textures/container_metal.png";
 const char* awesomefacePNG = "./resources/textures/awesomeface.png";
 const char* containerMetalSpecularPNG = "./resources/textures/container_metal_specular.png";
 
+const char* backpackOBJ = "./resources/backpack/backpack.obj";
+
+// linked program binaries of --program-cache
+const char* programCacheDir = "./resources/shader_cache";
+
+// calls glfwTerminate when main returns, after the locals declared later have been destroyed
+struct GlfwSession {
+    ~GlfwSession() { glfwTerminate(); }
+};
+
 void errorExit(std::string msg, int errorReturn);
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
-void processInput(GLFWwindow* window);
+CameraMovement processInput(GLFWwindow* window);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void benchmarkModelLoad(const std::string& path);
+void benchmarkLod(Model& model, const Shader& shader, UniformBuffer<FrameBlock>& frameUniforms);
+bool checkDrawAllocations(GLFWwindow* window, const Shader& shader, const Shader& quantizedShader, UniformBuffer<FrameBlock>& frameUniforms);
+void benchmarkShaderStartup();
+void countUniformLocationQueries();
+void reportUniformLocationQueries();
 
 // Settings
 unsigned int SCR_WIDTH = 800;
 unsigned int SCR_HEIGHT = 600;
 bool wireframeMode = false;
+bool benchmarkLoad = false;
+bool optimizeMeshes = false;
+bool quantizeVertices = false;
+bool drawIndirect = false;
+bool useLod = false;
+bool benchmarkLodThroughput = false;
+bool checkDrawAllocationCount = false;
+bool benchmarkUniforms = false;
+bool useProgramCache = false;
+bool benchmarkShaders = false;
+// reads resources/shaders at runtime even if the shaders are embedded, to edit them without rebuilding
+bool shadersFromDisk = false;
+// rebuilds programs whose shader files are saved while running, implies shadersFromDisk
+bool watchShaders = false;
+// --record-path logs the camera to this file, --play-path flies it along one instead of following input
+std::string recordPathFile;
+std::string playPathFile;
+bool playingCameraPath = false;
+// --late-latch polls input again right before the main pass, --measure-latency reports input to swap latency
+bool lateLatch = false;
+bool measureLatency = false;
+InputLatencyTracker inputLatency;
+// the camera's spot light, F toggles it and with it the lighting shader permutation
+bool flashlight = true;
+bool flashlightKeyDown = false;
+// glGetUniformLocation calls so far, and until the render loop started
+size_t uniformLocationQueries = 0;
+size_t uniformLocationQueriesAtLoad = 0;
+
+// --check-draw-allocations counts the allocations made on a thread while countingAllocations is set.
+// The operators below replace the global allocation functions of the whole program, so every allocation on every
+// thread goes through them, outside a counted section at the cost of one thread local test. The array and nothrow
+// forms call these by default, so the two operator new overloads see every allocation, over-aligned ones included.
+thread_local bool countingAllocations = false;
+thread_local size_t countedAllocations = 0;
+
+void* operator new(std::size_t size) {
+    if (countingAllocations) {
+        countedAllocations++;
+    }
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+// malloc only guarantees fundamental alignment, so the block is over-allocated and its address kept in front of the aligned memory
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (countingAllocations) {
+        countedAllocations++;
+    }
+    std::size_t align = static_cast<std::size_t>(alignment);
+    if (void* block = std::malloc(size + align + sizeof(void*))) {
+        std::uintptr_t aligned = (reinterpret_cast<std::uintptr_t>(block) + sizeof(void*) + align - 1) & ~std::uintptr_t(align - 1);
+        reinterpret_cast<void**>(aligned)[-1] = block;
+        return reinterpret_cast<void*>(aligned);
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+    if (memory) {
+        std::free(static_cast<void**>(memory)[-1]);
+    }
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept {
+    operator delete(memory, alignment);
+}
 
 // Camera
 Camera camera{glm::vec3(20.0f, 14.5f, 15.2f), glm::vec3(-0.6512f, -0.4769f, -0.5903f)};
 
-// Timing
+// Timing, deltaTime is the real time of the last frame, the simulation runs at a fixed timestep
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+// texture streaming, bytes of decoded image data uploaded per frame
+const size_t textureUploadBudget = 16 * 1024 * 1024;
+
 int main(int argc, char* argv[]) {
 
     // argument handling
-    if (argc == 2) {
-        std::string arg = argv[1];
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
         if (arg == "--w") {
             wireframeMode = true;
+        } else if (arg == "--bench-load") {
+            benchmarkLoad = true;
+        } else if (arg == "--optimize-meshes") {
+            optimizeMeshes = true;
+        } else if (arg == "--quantize") {
+            quantizeVertices = true;
+        } else if (arg == "--indirect") {
+            drawIndirect = true;
+        } else if (arg == "--lod") {
+            useLod = true;
+        } else if (arg == "--bench-lod") {
+            benchmarkLodThroughput = true;
+        } else if (arg == "--check-draw-allocations") {
+            checkDrawAllocationCount = true;
+        } else if (arg == "--bench-uniforms") {
+            benchmarkUniforms = true;
+        } else if (arg == "--program-cache") {
+            useProgramCache = true;
+        } else if (arg == "--bench-shaders") {
+            benchmarkShaders = true;
+        } else if (arg == "--shaders-from-disk") {
+            shadersFromDisk = true;
+        } else if (arg == "--watch-shaders") {
+            watchShaders = true;
+            shadersFromDisk = true;
+        } else if (arg == "--record-path" && i + 1 < argc) {
+            recordPathFile = argv[++i];
+        } else if (arg == "--play-path" && i + 1 < argc) {
+            playPathFile = argv[++i];
+        } else if (arg == "--late-latch") {
+            lateLatch = true;
+        } else if (arg == "--measure-latency") {
+            measureLatency = true;
         } else {
             std::cout << "Incorrect Program usage" << std::endl;
             exit(1);
         }
-    } else if (argc > 1) {
-        std::cout << "Incorrect Program usage" << std::endl;
-        exit(1);
     }
 
     glfwInit();
+    // terminates GLFW after every GL object owner declared below has released its objects
+    GlfwSession glfwSession;
 
     // gets the width and height of the primary monitor
     GLFWmonitor* primary = glfwGetPrimaryMonitor();
@@ -81,12 +238,30 @@ int main(int argc, char* argv[]) {
     glfwMakeContextCurrent(window);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetKeyCallback(window, key_callback);
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);  
+    // unaccelerated, unscaled mouse motion, it reaches the camera without the OS pointer processing
+    if (lateLatch && glfwRawMouseMotionSupported()) {
+        glfwSetInputMode(window, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
+    }
     
     // load all OpenGL function pointers using glad
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
         errorExit("Failed to initialize GLAD", -1);
     }
+    GLExtensions::load((GLADloadproc)glfwGetProcAddress);
+    if (benchmarkUniforms) {
+        countUniformLocationQueries();
+    }
+    if (useProgramCache && !ProgramCache::shared().enable(programCacheDir)) {
+        std::cout << "program binary cache is unavailable (no binary formats), compiling from source" << std::endl;
+    }
+    if (shadersFromDisk) {
+        ShaderFiles::readFromDisk();
+    }
+    if (watchShaders && !ShaderWatcher::shared().start(ShaderFiles::directory())) {
+        std::cout << "shader hot reload is unavailable" << std::endl;
+    }
 
     // if the wireframe mode is true, then render using GL_LINE
     if (wireframeMode) {
@@ -96,9 +271,49 @@ int main(int argc, char* argv[]) {
     // enable depth testing
     glEnable(GL_DEPTH_TEST);
 
-    // create shader programs
-    Shader shaderProgram(vertexPath, lightingFragPath);
-    Shader lightSourceShader(vertexPath, lightSourceFragPath);
+    if (benchmarkLoad) {
+        benchmarkModelLoad(backpackOBJ);
+        return 0;
+    }
+
+    if (benchmarkShaders) {
+        benchmarkShaderStartup();
+        return 0;
+    }
+
+    // camera and lights, uploaded once per frame and shared by every program
+    UniformBuffer<FrameBlock> frameUniforms;
+    UniformBuffer<LightsBlock> lightUniforms;
+    auto bindUniformBlocks = [](const Shader& program) {
+        program.bindUniformBlock(FrameBlock::blockName, FrameBlock::binding);
+        program.bindUniformBlock(LightsBlock::blockName, LightsBlock::binding);
+    };
+    // tell opengl for each sample to which texture unit it belongs to
+    MaterialUniforms material;
+    auto configureLighting = [&bindUniformBlocks, &material](Shader& program) {
+        bindUniformBlocks(program);
+        program.use();
+        UniformStruct<MaterialUniforms> materialUniform("material");
+        materialUniform.resolve(program);
+        materialUniform.upload(program, material);
+    };
+
+    // the lighting shaders are specialised per light setup instead of evaluating every light,
+    // lightSetups[flashlight] is the setup in use
+    ShaderDefines lightSetups[2];
+    for (int spotLight = 0; spotLight < 2; spotLight++) {
+        lightSetups[spotLight].set("POINT_LIGHT_COUNT", LightsBlock::pointLightCount).set("SPOT_LIGHT", spotLight);
+    }
+
+    // submit the shader builds, the driver compiles them while the model and textures load
+    ShaderPermutations lightingVariants(vertexPath, lightingFragPath, configureLighting);
+    ShaderPermutations quantizedVariants(quantizedVertexPath, lightingFragPath, configureLighting);
+    lightingVariants.prepare({lightSetups[1], lightSetups[0]});
+    if (quantizeVertices) {
+        quantizedVariants.prepare({lightSetups[1], lightSetups[0]});
+    }
+    Shader lightSourceShader = Shader::submit(vertexPath, lightSourceFragPath);
+    lightSourceShader.onReady(bindUniformBlocks);
 
     float vertices[] = {
         // positions          // normals           // texture coords
@@ -163,56 +378,10 @@ int main(int argc, char* argv[]) {
     // unbind VAO
     glBindVertexArray(0);
 
-    // load and create textures
-    unsigned int diffuseMap, specularMap;
-
-    // Texture 1
-    glGenTextures(1, &diffuseMap);
-    glBindTexture(GL_TEXTURE_2D, diffuseMap);
-    // set the texture wrapping/filtering options (on the currently bound texture object)
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char *data = stbi_load(containerMetalPNG, &width, &height, &nrChannels, 0);
-    if (data) {
-        // GL_RGB for JPG, GL_RGBA for PNG
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    } else {
-        std::cout << "Failed to load texture" << std::endl;
-    }
-    stbi_image_free(data);
-
-    // Texture 2
-    glGenTextures(1, &specularMap);
-    glBindTexture(GL_TEXTURE_2D, specularMap);
-    // set the texture wrapping/filtering options (on the currently bound texture object)
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_set_flip_vertically_on_load(true);
-    data = stbi_load(containerMetalSpecularPNG, &width, &height, &nrChannels, 0);
-    if (data) {
-        // GL_RGB for JPG, GL_RGBA for PNG
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    } else {
-        std::cout << "Failed to load texture" << std::endl;
-    }
-    stbi_image_free(data);
-    
-    // tell opengl for each sample to which texture unit it belongs to
-    shaderProgram.use();
-    shaderProgram.setInt("material.diffuse", 0);
-    shaderProgram.setInt("material.specular", 1);
-    shaderProgram.setFloat("material.shininess", 32.0f);
-     
+    // load and create textures (shared through the texture registry)
+    TextureHandle diffuseMap = TextureRegistry::shared().load2D(containerMetalPNG, true);
+    TextureHandle specularMap = TextureRegistry::shared().load2D(containerMetalSpecularPNG, true);
+
     unsigned int lightVAO;
     glGenVertexArrays(1, &lightVAO);
     glBindVertexArray(lightVAO);
@@ -245,10 +414,123 @@ int main(int argc, char* argv[]) {
     glm::vec3 moonLightColor(0.525f, 0.6f, 0.69f);
     glm::vec3 warmLightColor(0.85f, 0.52f, 0.33f);
 
+    // light parameters that stay fixed, positions and the spot light direction are updated per frame
+    LightsBlock& lights = lightUniforms.data();
+    for (PointLightBlock& pointLight : lights.pointLights) {
+        pointLight.constant = 1.0f;
+        pointLight.linear = 0.07f;
+        pointLight.quadratic = 0.017f;
+        pointLight.ambient = glm::vec3(0.05f) * warmLightColor;
+        pointLight.diffuse = glm::vec3(0.5f) * warmLightColor;
+        pointLight.specular = glm::vec3(0.9f) * warmLightColor;
+    }
+
+    lights.dirLight.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+    lights.dirLight.ambient = glm::vec3(0.05f) * moonLightColor;
+    lights.dirLight.diffuse = glm::vec3(0.14f) * moonLightColor;
+    lights.dirLight.specular = glm::vec3(0.4f) * moonLightColor;
+
+    lights.spotLight.innerCutOff = glm::cos(glm::radians(10.5f));
+    lights.spotLight.outerCutOff = glm::cos(glm::radians(15.5f));
+    lights.spotLight.constant = 1.0f;
+    lights.spotLight.linear = 0.027f;
+    lights.spotLight.quadratic = 0.0028f;
+    lights.spotLight.ambient = glm::vec3(0.1f);
+    lights.spotLight.diffuse = glm::vec3(0.8f);
+    lights.spotLight.specular = glm::vec3(1.0f);
+
+    // camera path recording or playback, the path is read before the slow loading starts
+    std::unique_ptr<CameraPathPlayback> pathPlayback;
+    if (!playPathFile.empty()) {
+        CameraPath path;
+        if (!path.load(playPathFile)) errorExit("Failed to load camera path", -1);
+        pathPlayback = std::make_unique<CameraPathPlayback>(std::move(path));
+        playingCameraPath = true;
+        // frames aren't held back to the refresh rate, so the frame times measure the rendering
+        glfwSwapInterval(0);
+    }
+    CameraPathRecorder pathRecorder;
+    if (!recordPathFile.empty() && !pathRecorder.open(recordPathFile)) {
+        errorExit("Failed to record camera path", -1);
+    }
+
+    if (checkDrawAllocationCount) {
+        Shader& program = lightingVariants.get(lightSetups[flashlight]);
+        Shader& quantizedProgram = quantizedVariants.get(lightSetups[flashlight]);
+        program.wait();
+        quantizedProgram.wait();
+        return checkDrawAllocations(window, program, quantizedProgram, frameUniforms) ? 0 : 1;
+    }
+
     // resets lastFrame before entering render loop
     lastFrame = glfwGetTime();
    
-    Model backpack("./resources/backpack/backpack.obj");
+    ModelLoadOptions backpackOptions;
+    backpackOptions.parallelMeshProcessing = true;
+    backpackOptions.flipTexturesVertically = true;
+    backpackOptions.optimizeMeshes = optimizeMeshes;
+    // the demo never touches the CPU side geometry after upload
+    backpackOptions.keepCpuData = false;
+    if (quantizeVertices) {
+        backpackOptions.vertexFormat = VertexFormat::Quantized16;
+    }
+    if (useLod || benchmarkLodThroughput) {
+        backpackOptions.lodLevels = 4;
+    }
+    Model backpack(backpackOBJ, backpackOptions);
+
+    if (optimizeMeshes && !backpack.loadedFromCache()) {
+        const MeshOptimizationStats& stats = backpack.getOptimizationStats();
+        std::cout << "mesh optimization: " << stats.before.vertices << " -> " << stats.after.vertices << " vertices, "
+                  << "ACMR " << stats.before.acmr() << " -> " << stats.after.acmr() << ", "
+                  << "ATVR " << stats.before.atvr() << " -> " << stats.after.atvr() << std::endl;
+    }
+
+    if (benchmarkLodThroughput) {
+        Shader& lodProgram = (quantizeVertices ? quantizedVariants : lightingVariants).get(lightSetups[flashlight]);
+        lodProgram.wait();
+        benchmarkLod(backpack, lodProgram, frameUniforms);
+        return 0;
+    }
+
+    // the indirect shaders need GL 4.3, they are only compiled when that path is taken
+    std::unique_ptr<ShaderPermutations> indirectVariants;
+    ShaderDefines indirectSetups[2] = {lightSetups[0], lightSetups[1]};
+    if (drawIndirect && !backpack.canDrawIndirect()) {
+        std::cout << "multi-draw indirect is unavailable (needs GL 4.3 and ARB_shader_draw_parameters, "
+                  << "unquantized vertices), drawing mesh by mesh" << std::endl;
+        drawIndirect = false;
+    } else if (drawIndirect) {
+        indirectVariants = std::make_unique<ShaderPermutations>(indirectVertexPath, indirectLightingFragPath, [&bindUniformBlocks](Shader& program) {
+            bindUniformBlocks(program);
+            program.use();
+            program.setFloat("shininess", 32.0f);
+        });
+        for (ShaderDefines& setup : indirectSetups) {
+            setup.set("BATCH_TEXTURES", static_cast<int>(Model::indirectBatchTextures));
+        }
+        indirectVariants->prepare({indirectSetups[1], indirectSetups[0]});
+    }
+
+    if (benchmarkUniforms) {
+        // the uniform tables are built when a build finishes, which has to count as loading
+        lightingVariants.wait();
+        quantizedVariants.wait();
+        lightSourceShader.wait();
+        if (indirectVariants) {
+            indirectVariants->wait();
+        }
+    }
+    uniformLocationQueriesAtLoad = uniformLocationQueries;
+    // sampler units and constants set while configuring the programs don't count towards the first frame
+    Shader::takeUniformUploadStats();
+
+    // camera and light movement are simulated at a fixed timestep, frames are rendered between the last two steps
+    FixedTimestep simulation;
+    Interpolated<glm::vec3> cameraPosition(camera.getPosition());
+    Interpolated<glm::vec3> movingLightPosition(pointLightPositions[0]);
+    // the camera frames are rendered from, looking where the simulated camera looks now
+    Camera viewCamera = camera;
 
     while (!glfwWindowShouldClose(window)) {
         // pre-frame time logic
@@ -256,120 +538,173 @@ int main(int argc, char* argv[]) {
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame; 
 
-        // input
-        processInput(window);
+        // input, a camera path replaces the camera movement and runs at its fixed timestep
+        CameraMovement cameraMovement = processInput(window);
+        if (pathPlayback) {
+            if (!pathPlayback->advance(camera)) {
+                pathPlayback->printReport("model loading");
+                break;
+            }
+            deltaTime = pathPlayback->timestep();
+            // the path places the camera, there is nothing to interpolate
+            cameraPosition = Interpolated<glm::vec3>(camera.getPosition());
+        }
+
+        // simulation
+        int steps = simulation.advance(deltaTime);
+        for (int step = 0; step < steps; step++) {
+            cameraPosition.beginStep();
+            movingLightPosition.beginStep();
+            if (!playingCameraPath) {
+                camera.move(cameraMovement, simulation.step());
+            }
+            cameraPosition.current = camera.getPosition();
+
+            // calculate point light movement
+            movingLightPosition.current += lightMovementDir * lightSpeed * simulation.step();
+            if (movingLightPosition.current.z < 0.8f || movingLightPosition.current.z > 9.0f) {
+                lightMovementDir *= -1;
+            }
+        }
+        // the simulated pose, at the time it was simulated to, frames without a step have nothing new to record
+        if (steps > 0) {
+            pathRecorder.record(simulation.simulatedTime(), camera);
+        }
+
+        float alpha = simulation.alpha();
+        viewCamera.setPose(CameraPose{cameraPosition.at(alpha), camera.getYaw(), camera.getPitch()});
+        pointLightPositions[0] = movingLightPosition.at(alpha);
+
+        // upload textures that finished decoding
+        TextureLoader::shared().uploadPending(textureUploadBudget);
+
+        // pick up saved shader files, the affected programs rebuild in the background and swap in from isReady
+        ShaderWatcher::shared().poll();
         
         // rendering commands
         glClearColor(moonLightColor.x * 0.009, moonLightColor.y * 0.009, moonLightColor.z * 0.009, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        
-        // activate shader
-        shaderProgram.use();
-        shaderProgram.setVec3("viewPosition", camera.getPosition());
-
-        // calculate point light movement
-        pointLightPositions[0] += lightMovementDir * lightSpeed * deltaTime;
-        if (pointLightPositions[0].z < 0.8f || pointLightPositions[0].z > 9.0f) {
-            lightMovementDir *= -1;
+
+        // late latch: handle the input that arrived during this frame's CPU work, so the view the main pass is
+        // drawn with is as fresh as possible. Mouse look applies straight away, movement stays with the simulation
+        if (lateLatch) {
+            glfwPollEvents();
+            viewCamera.setPose(CameraPose{viewCamera.getPosition(), camera.getYaw(), camera.getPitch()});
         }
 
-        // point lights
-        for (int i = 0; i < 4; i++) {
-            std::string uniformStr = "pointLights[" + std::to_string(i) + "]";
-            shaderProgram.setVec3(uniformStr + ".position", pointLightPositions[i]);
+        float aspectRatio = static_cast<float>(SCR_WIDTH) / static_cast<float>(SCR_HEIGHT);
+        glm::mat4 viewProjection = viewCamera.getViewProjectionMatrix(aspectRatio);
+        // objects entirely outside the view aren't drawn
+        Frustum frustum = Frustum::fromViewProjection(viewProjection);
+
+        // camera and light uniforms shared by every program
+        frameUniforms.data().viewProjection = viewProjection;
+        frameUniforms.data().viewPosition = viewCamera.getPosition();
+        frameUniforms.upload();
 
-            shaderProgram.setFloat(uniformStr + ".constant", 1.0f);
-            shaderProgram.setFloat(uniformStr + ".linear", 0.07f);
-            shaderProgram.setFloat(uniformStr + ".quadratic", 0.017f);
-            
-            shaderProgram.setVec3(uniformStr + ".ambient", glm::vec3(0.05f) * warmLightColor); 
-            shaderProgram.setVec3(uniformStr + ".diffuse", glm::vec3(0.5f) * warmLightColor);
-            shaderProgram.setVec3(uniformStr + ".specular", glm::vec3(0.9f) * warmLightColor);
+        for (int i = 0; i < LightsBlock::pointLightCount; i++) {
+            lights.pointLights[i].position = pointLightPositions[i];
         }
+        lights.spotLight.position = viewCamera.getPosition();
+        lights.spotLight.direction = viewCamera.getDirection();
+        lightUniforms.upload();
 
-        // directional light
-        shaderProgram.setVec3("dirLight.direction", glm::vec3(0.0f, -1.0f, 0.0f));
-        shaderProgram.setVec3("dirLight.ambient", glm::vec3(0.05f) * moonLightColor); 
-        shaderProgram.setVec3("dirLight.diffuse", glm::vec3(0.14f) * moonLightColor);
-        shaderProgram.setVec3("dirLight.specular", glm::vec3(0.4f) * moonLightColor);
-
-        // spot light
-        shaderProgram.setVec3("spotLight.position", camera.getPosition());
-        shaderProgram.setVec3("spotLight.direction", camera.getDirection());
-        shaderProgram.setFloat("spotLight.innerCutOff", glm::cos(glm::radians(10.5f)));
-        shaderProgram.setFloat("spotLight.outerCutOff", glm::cos(glm::radians(15.5f)));
-        shaderProgram.setFloat("spotLight.constant", 1.0f);
-        shaderProgram.setFloat("spotLight.linear", 0.027f);
-        shaderProgram.setFloat("spotLight.quadratic", 0.0028f);
-        shaderProgram.setVec3("spotLight.ambient", glm::vec3(0.1f)); 
-        shaderProgram.setVec3("spotLight.diffuse", glm::vec3(0.8f));
-        shaderProgram.setVec3("spotLight.specular", glm::vec3(1.0f));
-
-        float aspectRatio = static_cast<float>(SCR_WIDTH) / static_cast<float>(SCR_HEIGHT);
-        glm::mat4 viewProjection = camera.getViewProjectionMatrix(aspectRatio);
-        shaderProgram.setMat4("viewProjection", viewProjection);
-        
         // bind textures on corresponding texture units
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, diffuseMap);
+        glBindTexture(GL_TEXTURE_2D, diffuseMap->id);
         glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, specularMap);
-
-        // render boxes
-        int i = 0;
-        glBindVertexArray(VAO);
-        for (auto pos : cubePositions) {
-            // calculate the model matrix for each object and pass to shader before drawing
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), pos);
-            float angle = 20.0f * i++;
-            model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-            if (i % 3 == 0) {
-                model = glm::scale(model, glm::vec3(3.0f));
-            } else if (i % 2 == 0) {
-                model = glm::scale(model, glm::vec3(2.0f));
-            }
+        glBindTexture(GL_TEXTURE_2D, specularMap->id);
 
-            shaderProgram.setMat4("model", model);
+        // render boxes, programs still building are skipped until they have linked
+        Shader& lightingProgram = lightingVariants.get(lightSetups[flashlight]);
+        if (lightingProgram.isReady()) {
+            lightingProgram.use();
+            int i = 0;
+            glBindVertexArray(VAO);
+            for (auto pos : cubePositions) {
+                // calculate the model matrix for each object and pass to shader before drawing
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), pos);
+                float angle = 20.0f * i++;
+                model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
+                if (i % 3 == 0) {
+                    model = glm::scale(model, glm::vec3(3.0f));
+                } else if (i % 2 == 0) {
+                    model = glm::scale(model, glm::vec3(2.0f));
+                }
+                // the unit cube's bounding sphere, scaled uniformly with it
+                float boundsRadius = 0.5f * glm::sqrt(3.0f) * glm::length(glm::vec3(model[0]));
+                if (!frustum.intersectsSphere(pos, boundsRadius)) {
+                    continue;
+                }
+
+                lightingProgram.setMat4("model"_u, model);
            
-            // make sure normalMatrix calculation is AFTER model calculation
-            glm::mat3 normalMatrix = glm::transpose(glm::inverse(model));
-            shaderProgram.setMat3("normalMatrix", normalMatrix);
+                // make sure normalMatrix calculation is AFTER model calculation
+                glm::mat3 normalMatrix = glm::transpose(glm::inverse(model));
+                lightingProgram.setMat3("normalMatrix"_u, normalMatrix);
             
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
         }
        
         glm::mat4 model = glm::mat4(1.0f);
-        shaderProgram.setMat4("model", model);
-        backpack.draw(shaderProgram);
+        if (useLod) {
+            backpack.updateLod(model, viewCamera, static_cast<float>(SCR_HEIGHT));
+        }
+        if (drawIndirect) {
+            Shader& indirectProgram = indirectVariants->get(indirectSetups[flashlight]);
+            if (indirectProgram.isReady()) {
+                indirectProgram.use();
+                indirectProgram.setMat4("model", model);
+                indirectProgram.setMat3("normalMatrix", glm::mat3(model));
+                backpack.drawIndirect(indirectProgram);
+            }
+        } else if (quantizeVertices) {
+            Shader& quantizedProgram = quantizedVariants.get(lightSetups[flashlight]);
+            if (quantizedProgram.isReady()) {
+                quantizedProgram.use();
+                quantizedProgram.setMat4("model", model);
+                quantizedProgram.setMat3("normalMatrix", glm::mat3(model));
+                backpack.draw(quantizedProgram, frustum, model);
+            }
+        } else if (lightingProgram.isReady()) {
+            lightingProgram.use();
+            lightingProgram.setMat4("model", model);
+            backpack.draw(lightingProgram, frustum, model);
+        }
 
         // render light source
-        glBindVertexArray(VAO);
-        lightSourceShader.use();
-        lightSourceShader.setMat4("viewProjection", viewProjection);
+        if (lightSourceShader.isReady()) {
+            glBindVertexArray(VAO);
+            lightSourceShader.use();
         
-        for (auto lightPos : pointLightPositions) {
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(lightPos));
-            model = glm::scale(model, glm::vec3(0.2f));
+            for (auto lightPos : pointLightPositions) {
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(lightPos));
+                model = glm::scale(model, glm::vec3(0.2f));
             
-            lightSourceShader.setMat4("model", model);
-            lightSourceShader.setVec3("lightColor", warmLightColor);
+                lightSourceShader.setMat4("model", model);
+                lightSourceShader.setVec3("lightColor", warmLightColor);
             
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+            glBindVertexArray(0); 
+        }
+
+        if (benchmarkUniforms) {
+            reportUniformLocationQueries();
         }
-        glBindVertexArray(0); 
 
         // check and call events and swap the buffers
         glfwSwapBuffers(window);
+        if (measureLatency) {
+            inputLatency.frameSwapped();
+        }
         glfwPollEvents();
     }
 
     // clean up
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
-    glDeleteProgram(shaderProgram.ID);
-    glDeleteProgram(lightSourceShader.ID);
-
-    glfwTerminate();
 
     return 0;
 }
@@ -385,7 +720,8 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
 }
 
-void processInput(GLFWwindow* window) {
+// handles the window keys, returns the camera movement for the simulation
+CameraMovement processInput(GLFWwindow* window) {
     if(glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
         glfwSetWindowShouldClose(window, true);
     }
@@ -411,10 +747,18 @@ void processInput(GLFWwindow* window) {
         cameraMovement.addMovement(MovementDirection::Down);
     }
 
-    camera.move(cameraMovement, deltaTime);
+    // toggle once per press
+    bool flashlightKey = glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS;
+    if (flashlightKey && !flashlightKeyDown) {
+        flashlight = !flashlight;
+    }
+    flashlightKeyDown = flashlightKey;
+
+    return cameraMovement;
 }
 
 void mouse_callback(GLFWwindow* window, double xPos, double yPos) {
+    inputLatency.stampInput();
     static bool firstMouse = true;
     static double lastX, lastY;
 
@@ -431,5 +775,307 @@ void mouse_callback(GLFWwindow* window, double xPos, double yPos) {
     lastX = xPos;
     lastY = yPos;
 
-    camera.rotate(deltaX, -deltaY);
+    if (!playingCameraPath) {
+        camera.rotate(deltaX, -deltaY);
+    }
+}
+
+// the keys are read with glfwGetKey, the callback only timestamps the events
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    (void) window; (void) key; (void) scancode; (void) action; (void) mods; // ignore unused variable warnings
+    inputLatency.stampInput();
+}
+
+/**
+ * Compares the cold (Assimp import) and warm (mapped mesh cache) model load paths.
+ * Includes the GPU upload, glFinish makes sure it has completed before the timer stops.
+ * Then reports the geometry arena's occupancy and fragmentation with a gap left by a freed model,
+ * and again after defragmenting it.
+ */
+void benchmarkModelLoad(const std::string& path) {
+    using Clock = std::chrono::steady_clock;
+    const int warmRuns = 5;
+
+    auto timeLoad = [&path](ModelLoadOptions options, bool& fromCache) {
+        auto start = Clock::now();
+        {
+            Model model(path, options);
+            TextureLoader::shared().finish();
+            glFinish();
+            fromCache = model.loadedFromCache();
+        }
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    bool fromCache;
+    ModelLoadOptions noCache;
+    noCache.useMeshCache = false;
+    double importOnly = timeLoad(noCache, fromCache);
+
+    std::filesystem::remove(MeshCache::cachePathFor(path));
+    double cold = timeLoad(ModelLoadOptions(), fromCache);
+
+    double warm = 0.0;
+    bool allWarm = true;
+    for (int i = 0; i < warmRuns; i++) {
+        warm += timeLoad(ModelLoadOptions(), fromCache);
+        allWarm = allWarm && fromCache;
+    }
+    warm /= warmRuns;
+
+    std::cout << "model load benchmark: " << path << std::endl;
+    std::cout << "  import (no cache):   " << importOnly << " ms" << std::endl;
+    std::cout << "  cold (import+write): " << cold << " ms" << std::endl;
+    std::cout << "  warm (mapped cache): " << warm << " ms (avg of " << warmRuns << ")" << std::endl;
+    if (!allWarm) {
+        std::cout << "  WARNING: warm runs did not hit the mesh cache" << std::endl;
+    }
+
+    GeometryArena<Vertex>& arena = GeometryArena<Vertex>::shared();
+    auto printArena = [&arena](const char* state) {
+        const RangeAllocator& vertices = arena.vertexAllocator();
+        const RangeAllocator& indices = arena.indexAllocator();
+        std::cout << "  arena " << state << ": vertices " << vertices.occupancy() * 100.0f << "% used, "
+                  << vertices.fragmentation() * 100.0f << "% fragmented (" << vertices.freeBlockCount()
+                  << " free blocks), indices " << indices.occupancy() * 100.0f << "% used, "
+                  << indices.fragmentation() * 100.0f << "% fragmented (" << indices.freeBlockCount()
+                  << " free blocks), " << arena.relocationCount() << " relocations" << std::endl;
+    };
+
+    // two copies loaded back to back, freeing the first leaves a gap in front of the second
+    auto first = std::make_unique<Model>(path);
+    Model second(path);
+    TextureLoader::shared().finish();
+    first.reset();
+    printArena("with a gap");
+    arena.defragment();
+    glFinish();
+    printArena("defragmented");
+}
+
+/**
+ * Renders the model from increasing distances, once pinned to full resolution and once with
+ * screen-space LOD selection, and reports the submitted triangles and the resulting throughput.
+ * Every frame ends with glFinish so the timings cover the GPU work.
+ */
+void benchmarkLod(Model& model, const Shader& shader, UniformBuffer<FrameBlock>& frameUniforms) {
+    using Clock = std::chrono::steady_clock;
+    const int frames = 100;
+    const float distances[] = {2.0f, 4.0f, 8.0f, 16.0f, 32.0f, 64.0f};
+
+    TextureLoader::shared().finish();
+
+    float aspectRatio = static_cast<float>(SCR_WIDTH) / static_cast<float>(SCR_HEIGHT);
+    glm::mat4 modelMatrix = glm::mat4(1.0f);
+    shader.use();
+    shader.setMat4("model", modelMatrix);
+    shader.setMat3("normalMatrix", glm::mat3(modelMatrix));
+
+    auto timeFrames = [&model, &shader]() {
+        auto start = Clock::now();
+        for (int i = 0; i < frames; i++) {
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            model.draw(shader);
+            glFinish();
+        }
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+    };
+
+    std::cout << "LOD benchmark (" << SCR_HEIGHT << "px viewport, " << frames << " frames per distance)" << std::endl;
+    for (float distance : distances) {
+        Camera viewer(glm::vec3(0.0f, 0.0f, distance), glm::vec3(0.0f, 0.0f, -1.0f));
+        frameUniforms.data().viewProjection = viewer.getViewProjectionMatrix(aspectRatio);
+        frameUniforms.data().viewPosition = viewer.getPosition();
+        frameUniforms.upload();
+
+        model.setLodLevel(0);
+        size_t fullTriangles = model.drawnTriangleCount();
+        double fullTime = timeFrames();
+
+        model.updateLod(modelMatrix, viewer, static_cast<float>(SCR_HEIGHT));
+        size_t lodTriangles = model.drawnTriangleCount();
+        double lodTime = timeFrames();
+
+        std::cout << "  distance " << distance << ": full " << fullTriangles << " tris " << fullTime << " ms ("
+                  << fullTriangles / fullTime / 1000.0 << " Mtris/s), lod " << lodTriangles << " tris " << lodTime << " ms ("
+                  << lodTriangles / lodTime / 1000.0 << " Mtris/s)" << std::endl;
+    }
+}
+
+/**
+ * Draws the backpack loaded with Float32 and with Quantized16 vertices for a number of frames, through both
+ * Model::draw overloads, and counts the heap allocations the draws make. The first frame may size the culling
+ * buffers, every later one has to draw without allocating. Returns false if any of them allocated.
+ */
+bool checkDrawAllocations(GLFWwindow* window, const Shader& shader, const Shader& quantizedShader, UniformBuffer<FrameBlock>& frameUniforms) {
+    const int frames = 100;
+
+    ModelLoadOptions options;
+    options.flipTexturesVertically = true;
+    options.keepCpuData = false;
+    Model model(backpackOBJ, options);
+    options.vertexFormat = VertexFormat::Quantized16;
+    Model quantizedModel(backpackOBJ, options);
+    TextureLoader::shared().finish();
+
+    float aspectRatio = static_cast<float>(SCR_WIDTH) / static_cast<float>(SCR_HEIGHT);
+    frameUniforms.data().viewProjection = camera.getViewProjectionMatrix(aspectRatio);
+    frameUniforms.data().viewPosition = camera.getPosition();
+    frameUniforms.upload();
+    Frustum frustum = camera.getFrustum(aspectRatio);
+    glm::mat4 modelMatrix(1.0f);
+
+    size_t firstFrameAllocations = 0;
+    size_t laterAllocations = 0;
+    for (int frame = 0; frame < frames; frame++) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        countedAllocations = 0;
+        countingAllocations = true;
+        shader.use();
+        model.draw(shader, frustum, modelMatrix);
+        model.draw(shader);
+        quantizedShader.use();
+        quantizedModel.draw(quantizedShader, frustum, modelMatrix);
+        quantizedModel.draw(quantizedShader);
+        countingAllocations = false;
+        (frame == 0 ? firstFrameAllocations : laterAllocations) += countedAllocations;
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    std::cout << "draw allocations: " << firstFrameAllocations << " in the first frame, " << laterAllocations
+              << " in the " << frames - 1 << " frames after it" << std::endl;
+    if (laterAllocations > 0) {
+        std::cout << "  FAILED: Model::draw allocated after the first frame" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Times building every program the demo uses: compiled from source one at a time and submitted together,
+ * with an empty program binary cache (compile and write) and from a warm cache. The link status query in Shader
+ * waits for each link to finish. Drivers may keep their own shader cache (Mesa: MESA_SHADER_CACHE_DISABLE=true),
+ * which narrows the gaps and favours every run after the first.
+ */
+void benchmarkShaderStartup() {
+    using Clock = std::chrono::steady_clock;
+    const int warmRuns = 5;
+    const std::pair<const char*, const char*> programs[] = {
+        {vertexPath, lightingFragPath},
+        {vertexPath, lightSourceFragPath},
+        {quantizedVertexPath, lightingFragPath},
+    };
+
+    // one program after another, or every build submitted before waiting for the first
+    auto timePrograms = [&programs](bool submitAll = false) {
+        auto start = Clock::now();
+        if (submitAll) {
+            std::vector<Shader> shaders;
+            for (const auto& program : programs) {
+                shaders.push_back(Shader::submit(program.first, program.second));
+            }
+            for (Shader& shader : shaders) {
+                shader.wait();
+            }
+        } else {
+            for (const auto& program : programs) {
+                Shader shader(program.first, program.second);
+            }
+        }
+        glFinish();
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    ProgramCache& cache = ProgramCache::shared();
+    cache.disable();
+    double source = timePrograms();
+    double submitted = timePrograms(true);
+
+    std::error_code error;
+    std::filesystem::remove_all(programCacheDir, error);
+    if (!cache.enable(programCacheDir)) {
+        std::cout << "program binary cache is unavailable (no binary formats), source compile: " << source << " ms" << std::endl;
+        return;
+    }
+    double cold = timePrograms();
+
+    double warm = 0.0;
+    size_t hitsBefore = cache.hitCount();
+    for (int i = 0; i < warmRuns; i++) {
+        warm += timePrograms();
+    }
+    warm /= warmRuns;
+
+    std::cout << "shader startup benchmark (" << std::size(programs) << " programs)" << std::endl;
+    std::cout << "  source compile:      " << source << " ms" << std::endl;
+    std::cout << "  submitted together:  " << submitted << " ms (parallel compile "
+              << (GLExtensions::features().parallelShaderCompile ? "supported" : "unsupported") << ")" << std::endl;
+    std::cout << "  cold (compile+write): " << cold << " ms" << std::endl;
+    std::cout << "  warm (binary cache):  " << warm << " ms (avg of " << warmRuns << ")" << std::endl;
+    if (cache.hitCount() - hitsBefore != warmRuns * std::size(programs)) {
+        std::cout << "  WARNING: warm runs did not all hit the program cache ("
+                  << cache.rejectedCount() << " binaries rejected by the driver)" << std::endl;
+    }
+}
+
+// glGetUniformLocation as loaded by glad, wrapped by countingGetUniformLocation for --bench-uniforms
+PFNGLGETUNIFORMLOCATIONPROC loadedGetUniformLocation = nullptr;
+
+GLint APIENTRY countingGetUniformLocation(GLuint program, const GLchar* name) {
+    uniformLocationQueries++;
+    return loadedGetUniformLocation(program, name);
+}
+
+/**
+ * Routes every glGetUniformLocation call through a counter, must be called after gladLoadGLLoader.
+ */
+void countUniformLocationQueries() {
+    loadedGetUniformLocation = glad_glGetUniformLocation;
+    glad_glGetUniformLocation = countingGetUniformLocation;
+}
+
+/**
+ * Called once per frame. Prints the glGetUniformLocation calls made while loading (shader reflection)
+ * and per frame, and the uniform updates issued and skipped as redundant per frame,
+ * then ends the program after a fixed number of frames.
+ */
+void reportUniformLocationQueries() {
+    const int frames = 200;
+    static int frame = 0;
+    static size_t lastCount = 0;
+    static size_t firstFrameQueries = 0;
+    static size_t steadyQueries = 0;
+    static UniformUploadStats firstFrameUploads;
+    static UniformUploadStats steadyUploads;
+
+    if (frame == 0) {
+        lastCount = uniformLocationQueriesAtLoad;
+    }
+    size_t frameQueries = uniformLocationQueries - lastCount;
+    lastCount = uniformLocationQueries;
+
+    UniformUploadStats frameUploads = Shader::takeUniformUploadStats();
+
+    if (frame == 0) {
+        firstFrameQueries = frameQueries;
+        firstFrameUploads = frameUploads;
+    } else {
+        steadyQueries += frameQueries;
+        steadyUploads += frameUploads;
+    }
+
+    if (++frame == frames) {
+        std::cout << "uniform location benchmark (" << frames << " frames)" << std::endl;
+        std::cout << "  glGetUniformLocation at load:       " << uniformLocationQueriesAtLoad << std::endl;
+        std::cout << "  glGetUniformLocation first frame:   " << firstFrameQueries << std::endl;
+        std::cout << "  glGetUniformLocation per frame:     " << double(steadyQueries) / (frames - 1) << std::endl;
+        std::cout << "  uniform updates first frame:        " << firstFrameUploads.issued << " issued, "
+                  << firstFrameUploads.skipped << " skipped" << std::endl;
+        std::cout << "  uniform updates per frame:          " << double(steadyUploads.issued) / (frames - 1) << " issued, "
+                  << double(steadyUploads.skipped) / (frames - 1) << " skipped" << std::endl;
+        glfwSetWindowShouldClose(glfwGetCurrentContext(), true);
+    }
 }
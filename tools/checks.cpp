@@ -0,0 +1,842 @@
+/**
+ * CPU only checks of the engine headers, they need no window, GL context or Assimp library (the GL calls
+ * of the uniform struct check go to a stand-in driver).
+ * Built for and run on the build machine by `make check`, from the repository root as some checks read resources/.
+ *
+ * usage: checks [check]...   runs the named checks, or all of them, and exits non-zero if any fails
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "camera.h"
+#include "frustum.h"
+#include "model.h"
+#include "range_allocator.h"
+#include "texture_loader.h"
+#include "thread_pool.h"
+#include "uniform_blocks.h"
+#include "uniform_struct.h"
+#include "vertex_quantization.h"
+
+/**
+ * Converts synthetic meshes of uneven sizes serially and on the worker pool, Model::convertMeshes is the
+ * aiMesh -> Vertex/index phase of a model load. The parallel results have to equal the serial ones in work list
+ * order, the timings of both are reported.
+ */
+bool checkMeshConversion() {
+    using Clock = std::chrono::steady_clock;
+    const int runs = 10;
+    const unsigned int meshCount = 64;
+
+    // grids of two triangles per cell, every mesh at its own depth so results in the wrong slot differ
+    std::vector<std::unique_ptr<aiMesh>> meshes;
+    std::vector<const aiMesh*> workList;
+    for (unsigned int m = 0; m < meshCount; m++) {
+        unsigned int side = 32 + (m * 37) % 160;
+        auto mesh = std::make_unique<aiMesh>();
+        mesh->mNumVertices = side * side;
+        mesh->mVertices = new aiVector3D[mesh->mNumVertices];
+        mesh->mNormals = new aiVector3D[mesh->mNumVertices];
+        // some meshes without texture coordinates, which convert to zero
+        if (m % 8 != 7) {
+            mesh->mTextureCoords[0] = new aiVector3D[mesh->mNumVertices];
+            mesh->mNumUVComponents[0] = 2;
+        }
+        for (unsigned int y = 0; y < side; y++) {
+            for (unsigned int x = 0; x < side; x++) {
+                unsigned int v = y * side + x;
+                mesh->mVertices[v] = aiVector3D(float(x), float(y), float(m));
+                mesh->mNormals[v] = aiVector3D(0.0f, 0.0f, 1.0f);
+                if (mesh->mTextureCoords[0]) {
+                    mesh->mTextureCoords[0][v] = aiVector3D(float(x) / float(side - 1), float(y) / float(side - 1), 0.0f);
+                }
+            }
+        }
+
+        mesh->mNumFaces = (side - 1) * (side - 1) * 2;
+        mesh->mFaces = new aiFace[mesh->mNumFaces];
+        unsigned int face = 0;
+        for (unsigned int y = 0; y + 1 < side; y++) {
+            for (unsigned int x = 0; x + 1 < side; x++) {
+                unsigned int v = y * side + x;
+                const unsigned int triangles[2][3] = {{v, v + 1, v + side}, {v + 1, v + side + 1, v + side}};
+                for (const auto& triangle : triangles) {
+                    mesh->mFaces[face].mNumIndices = 3;
+                    mesh->mFaces[face].mIndices = new unsigned int[3]{triangle[0], triangle[1], triangle[2]};
+                    face++;
+                }
+            }
+        }
+        workList.push_back(mesh.get());
+        meshes.push_back(std::move(mesh));
+    }
+
+    auto timeConversion = [&workList](bool parallel, std::vector<MeshData>& meshData) {
+        ModelLoadOptions options;
+        options.parallelMeshProcessing = parallel;
+
+        double total = 0.0;
+        for (int i = 0; i < runs; i++) {
+            auto start = Clock::now();
+            meshData = Model::convertMeshes(workList, options);
+            total += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+        return total / runs;
+    };
+
+    std::vector<MeshData> serialData;
+    std::vector<MeshData> parallelData;
+    double serial = timeConversion(false, serialData);
+    double parallel = timeConversion(true, parallelData);
+
+    auto sameVertex = [](const Vertex& a, const Vertex& b) {
+        return a.position == b.position && a.normal == b.normal && a.texCoords == b.texCoords;
+    };
+    size_t mismatches = 0;
+    for (size_t i = 0; i < workList.size(); i++) {
+        const MeshData& a = serialData[i];
+        const MeshData& b = parallelData[i];
+        bool same = a.indices == b.indices && a.vertices.size() == b.vertices.size()
+            && std::equal(a.vertices.begin(), a.vertices.end(), b.vertices.begin(), sameVertex)
+            && a.vertices.size() == workList[i]->mNumVertices && a.indices.size() == size_t(workList[i]->mNumFaces) * 3;
+        if (!same && mismatches++ < 5) {
+            std::cout << "  FAILED: mesh " << i << " converted differently on the worker pool" << std::endl;
+        }
+    }
+
+    std::cout << "mesh conversion check: " << workList.size() << " meshes" << std::endl;
+    std::cout << "  serial:   " << serial << " ms" << std::endl;
+    std::cout << "  parallel: " << parallel << " ms (" << ThreadPool::shared().threadCount() << " workers)" << std::endl;
+    std::cout << "  speedup:  " << serial / parallel << "x" << std::endl;
+    return mismatches == 0;
+}
+
+const char* const checkTextures[] = {
+    "./resources/textures/container.jpg",
+    "./resources/textures/container_metal.png",
+    "./resources/textures/awesomeface.png",
+    "./resources/textures/container_metal_specular.png"
+};
+
+/**
+ * Decodes the repo textures on the worker pool, each one flipped and not flipped in the same batch so the
+ * two settings run side by side on the workers. Every decode has to match a reference decoded on this thread,
+ * flipped ones row for row upside down, and a missing file has to come back without pixels.
+ */
+bool checkTextureDecode() {
+    const int repeats = 8;
+    const std::string missingPath = "./resources/textures/missing.png";
+
+    auto decode = [](const std::string& path, bool flipVertically) {
+        TextureRequest request;
+        request.path = path;
+        request.flipVertically = flipVertically;
+        return decodeImage(std::move(request));
+    };
+
+    std::vector<DecodedImage> references;
+    for (const char* path : checkTextures) {
+        references.push_back(decode(path, false));
+        if (!references.back().pixels) {
+            std::cout << "  FAILED: " << path << " could not be decoded" << std::endl;
+            return false;
+        }
+    }
+
+    // every path flipped and not flipped, repeatedly, in one batch
+    std::vector<std::pair<std::string, bool>> requests;
+    for (int repeat = 0; repeat < repeats; repeat++) {
+        for (const char* path : checkTextures) {
+            requests.emplace_back(path, repeat % 2 == 0);
+            requests.emplace_back(path, repeat % 2 != 0);
+        }
+        requests.emplace_back(missingPath, repeat % 2 == 0);
+    }
+    std::vector<DecodedImage> images(requests.size());
+    ThreadPool::shared().parallelFor(requests.size(), [&](size_t i) {
+        images[i] = decode(requests[i].first, requests[i].second);
+    });
+
+    size_t failures = 0;
+    for (size_t i = 0; i < images.size(); i++) {
+        const DecodedImage& image = images[i];
+        const std::string& path = requests[i].first;
+        bool flipped = requests[i].second;
+        std::string failure;
+
+        if (path == missingPath) {
+            if (image.pixels) {
+                failure = "a missing file decoded to pixels";
+            }
+        } else {
+            size_t index = std::find(std::begin(checkTextures), std::end(checkTextures), path) - std::begin(checkTextures);
+            const DecodedImage& reference = references[index];
+            size_t rowSize = size_t(reference.width) * size_t(reference.channels);
+            auto row = [rowSize](const DecodedImage& decoded, int y) {
+                return decoded.pixels.get() + size_t(y) * rowSize;
+            };
+            auto rowsMatch = [&](int y) {
+                int referenceY = flipped ? reference.height - 1 - y : y;
+                return std::memcmp(row(image, y), row(reference, referenceY), rowSize) == 0;
+            };
+
+            if (!image.pixels || image.width != reference.width || image.height != reference.height
+                || image.channels != reference.channels) {
+                failure = "size or channels differ from the reference";
+            } else if (!rowsMatch(0) || !rowsMatch(image.height - 1)) {
+                failure = "first or last row doesn't match the reference";
+            } else {
+                for (int y = 1; y < image.height - 1 && failure.empty(); y++) {
+                    if (!rowsMatch(y)) {
+                        failure = "row " + std::to_string(y) + " doesn't match the reference";
+                    }
+                }
+            }
+        }
+
+        if (!failure.empty() && failures++ < 5) {
+            std::cout << "  FAILED: " << path << (flipped ? " flipped: " : ": ") << failure << std::endl;
+        }
+    }
+
+    // the first and last rows have to differ, or a decode that ignored the flip would pass
+    bool flipVisible = false;
+    for (const DecodedImage& reference : references) {
+        size_t rowSize = size_t(reference.width) * size_t(reference.channels);
+        const unsigned char* lastRow = reference.pixels.get() + size_t(reference.height - 1) * rowSize;
+        flipVisible = flipVisible || std::memcmp(reference.pixels.get(), lastRow, rowSize) != 0;
+    }
+    if (!flipVisible) {
+        std::cout << "  FAILED: no texture has distinct first and last rows, flipping can't be verified" << std::endl;
+        failures++;
+    }
+
+    std::cout << "texture decode check: " << images.size() << " decodes on " << ThreadPool::shared().threadCount()
+              << " workers, " << failures << " failed" << std::endl;
+    return failures == 0;
+}
+
+// the attributes of Vertex, without pulling in mesh.h and its GL dependencies
+struct CheckVertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoords;
+};
+
+/**
+ * Round trips random and edge case vertices through the CPU encode/decode of the quantized vertex format
+ * and checks every attribute against its error bound.
+ */
+bool checkQuantization() {
+    // octahedral snorm16 normals, the measured worst case is under 0.004 degrees
+    const float maxNormalError = glm::radians(0.01f);
+    // half floats round to 11 significant bits, below 2^-14 the spacing is a fixed 2^-24
+    auto maxTexCoordError = [](float value) {
+        return std::max(std::abs(value) * (1.0f / 2048.0f), 1.0f / 16777216.0f);
+    };
+
+    auto maxComponent = [](glm::vec3 v) {
+        return std::max(v.x, std::max(v.y, v.z));
+    };
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> texCoord(-4.0f, 4.0f);
+    std::uniform_real_distribution<float> magnitude(-3.0f, 3.0f);
+
+    // random meshes of every size and placement, and flat ones whose bounds have a zero extent axis
+    std::vector<std::vector<CheckVertex>> meshes;
+    for (int mesh = 0; mesh < 64; mesh++) {
+        glm::vec3 center = glm::vec3(unit(random), unit(random), unit(random)) * std::pow(10.0f, magnitude(random));
+        glm::vec3 extent = glm::vec3(std::pow(10.0f, magnitude(random)), std::pow(10.0f, magnitude(random)), std::pow(10.0f, magnitude(random)));
+        std::vector<CheckVertex> vertices(1000);
+        for (CheckVertex& vertex : vertices) {
+            vertex.position = center + extent * glm::vec3(unit(random), unit(random), unit(random));
+            vertex.normal = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(1e-6f));
+            vertex.texCoords = glm::vec2(texCoord(random), texCoord(random));
+        }
+        if (mesh % 4 == 1) {
+            for (CheckVertex& vertex : vertices) {
+                vertex.position.y = center.y;
+            }
+        } else if (mesh % 4 == 2) {
+            for (CheckVertex& vertex : vertices) {
+                vertex.position = center;
+            }
+        }
+        meshes.push_back(std::move(vertices));
+    }
+
+    // the axes, where the octahedral fold meets the edges of the square, and exact texture coordinates
+    std::vector<CheckVertex> edgeCases;
+    const glm::vec3 edgeNormals[] = {
+        {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1},
+        glm::normalize(glm::vec3(1, 1, 0)), glm::normalize(glm::vec3(-1, 0, -1)), glm::normalize(glm::vec3(-1, -1, -1))
+    };
+    const glm::vec2 edgeTexCoords[] = {{0, 0}, {1, 1}, {-1, 0.5f}, {0, 1}};
+    for (size_t i = 0; i < std::size(edgeNormals); i++) {
+        CheckVertex vertex;
+        vertex.position = glm::vec3(i % 2 ? 1.0f : -1.0f, 0.0f, static_cast<float>(i));
+        vertex.normal = edgeNormals[i];
+        vertex.texCoords = edgeTexCoords[i % std::size(edgeTexCoords)];
+        edgeCases.push_back(vertex);
+    }
+    meshes.push_back(std::move(edgeCases));
+
+    size_t vertexCount = 0;
+    size_t failures = 0;
+    float worstPosition = 0.0f;
+    float worstNormal = 0.0f;
+    float worstTexCoord = 0.0f;
+    for (const std::vector<CheckVertex>& vertices : meshes) {
+        PositionBounds bounds = VertexQuantization::computeBounds(vertices.data(), vertices.size());
+        glm::vec3 maxPositionError = VertexQuantization::maxPositionError(bounds);
+        for (const CheckVertex& vertex : vertices) {
+            CheckVertex decoded = VertexQuantization::decode<CheckVertex>(VertexQuantization::encode(vertex, bounds), bounds);
+            glm::vec3 positionError = glm::abs(decoded.position - vertex.position);
+            // the chord form stays precise for tiny angles, acos near 1 would lose them to float rounding
+            float normalError = 2.0f * std::asin(std::min(glm::length(decoded.normal - vertex.normal) * 0.5f, 1.0f));
+            glm::vec2 texCoordError = glm::abs(decoded.texCoords - vertex.texCoords);
+
+            bool inBounds = glm::all(glm::lessThanEqual(positionError, maxPositionError))
+                && normalError <= maxNormalError
+                && texCoordError.x <= maxTexCoordError(vertex.texCoords.x)
+                && texCoordError.y <= maxTexCoordError(vertex.texCoords.y);
+            if (!inBounds && failures++ < 5) {
+                std::cout << "  vertex (" << vertex.position.x << ", " << vertex.position.y << ", " << vertex.position.z
+                          << ") out of bounds: position error (" << positionError.x << ", " << positionError.y << ", "
+                          << positionError.z << "), normal " << glm::degrees(normalError) << " degrees, texCoords ("
+                          << texCoordError.x << ", " << texCoordError.y << ")" << std::endl;
+            }
+            worstPosition = std::max(worstPosition, maxComponent(positionError / glm::max(maxPositionError, glm::vec3(1e-30f))));
+            worstNormal = std::max(worstNormal, normalError);
+            worstTexCoord = std::max(worstTexCoord, std::max(texCoordError.x, texCoordError.y));
+            vertexCount++;
+        }
+    }
+
+    std::cout << "quantization check: " << vertexCount << " vertices, worst position error " << worstPosition
+              << " of its bound, worst normal error " << glm::degrees(worstNormal) << " degrees (bound "
+              << glm::degrees(maxNormalError) << "), worst texCoord error " << worstTexCoord << std::endl;
+    if (failures > 0) {
+        std::cout << "  FAILED: " << failures << " vertices out of bounds" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Exercises RangeAllocator on fixed layouts whose outcome is known: best fit allocation, coalescing on free,
+ * growth into a trailing free block, compaction and the statistics, then checks its invariants through a
+ * random allocate/free sequence.
+ */
+bool checkRangeAllocator() {
+    size_t checks = 0;
+    size_t failures = 0;
+    auto expect = [&checks, &failures](bool condition, const std::string& what) {
+        checks++;
+        if (!condition) {
+            failures++;
+            std::cout << "  FAILED: " << what << std::endl;
+        }
+    };
+    auto allocateAt = [](RangeAllocator& allocator, uint32_t size) {
+        uint32_t offset = UINT32_MAX;
+        return allocator.allocate(size, offset) ? offset : UINT32_MAX;
+    };
+
+    // best fit: with free blocks of 20 at 10, 30 at 40 and 25 at 80, a 22 goes to the 25 and not to the first fit
+    {
+        RangeAllocator allocator(105);
+        for (uint32_t size : {10u, 20u, 10u, 30u, 10u}) {
+            allocateAt(allocator, size);
+        }
+        allocator.free(10);
+        allocator.free(40);
+        expect(allocator.freeBlockCount() == 3, "best fit: three free blocks before allocating");
+        expect(allocateAt(allocator, 22) == 80, "best fit: 22 units go to the 25 unit block at 80");
+        expect(allocateAt(allocator, 18) == 10, "best fit: 18 units go to the 20 unit block at 10");
+        expect(allocateAt(allocator, 30) == 40, "best fit: 30 units fill the 30 unit block at 40 exactly");
+        expect(allocateAt(allocator, 4) == UINT32_MAX, "best fit: 4 units fail with only 2 and 3 unit blocks left");
+        expect(allocator.usedSize() == 100 && allocator.freeBlockCount() == 2, "best fit: used size and free blocks");
+    }
+
+    // coalescing: freeing the middle of three allocations merges it with the free blocks on both sides
+    {
+        RangeAllocator allocator(30);
+        uint32_t a = allocateAt(allocator, 10);
+        uint32_t b = allocateAt(allocator, 10);
+        uint32_t c = allocateAt(allocator, 10);
+        allocator.free(a);
+        allocator.free(c);
+        expect(allocator.freeBlockCount() == 2, "coalescing: the outer allocations free as two blocks");
+        allocator.free(b);
+        expect(allocator.freeBlockCount() == 1 && allocator.largestFreeBlock() == 30,
+            "coalescing: freeing the middle merges all three into one block");
+        allocator.free(b);
+        expect(allocator.freeSize() == 30 && allocator.allocationCount() == 0, "coalescing: a second free is ignored");
+        expect(allocateAt(allocator, 30) == 0, "coalescing: the whole space can be allocated again");
+    }
+
+    // growth: the added units merge with a trailing free block, or form one after a full space
+    {
+        RangeAllocator allocator(20);
+        allocateAt(allocator, 10);
+        allocator.grow(50);
+        expect(allocator.capacity() == 50 && allocator.freeBlockCount() == 1 && allocator.largestFreeBlock() == 40,
+            "grow: the new units merge with the trailing free block");
+        expect(allocateAt(allocator, 40) == 10, "grow: the merged block is allocated in one piece");
+        allocator.grow(60);
+        expect(allocator.freeBlockCount() == 1 && allocateAt(allocator, 10) == 50, "grow: a full space gains a tail block");
+        allocator.grow(30);
+        expect(allocator.capacity() == 60 && allocator.freeSize() == 0, "grow: shrinking is ignored");
+    }
+
+    // compaction: allocations slide down in ascending order, leaving one free block at the end
+    {
+        RangeAllocator allocator(100);
+        for (uint32_t size : {10u, 20u, 10u, 30u, 10u}) {
+            allocateAt(allocator, size);
+        }
+        allocator.free(10);
+        allocator.free(40);
+        std::vector<RangeMove> moves = allocator.compact();
+        bool expectedMoves = moves.size() == 2
+            && moves[0].from == 30 && moves[0].to == 10 && moves[0].size == 10
+            && moves[1].from == 70 && moves[1].to == 20 && moves[1].size == 10;
+        expect(expectedMoves, "compact: the allocations at 30 and 70 move to 10 and 20, in that order");
+        expect(allocator.freeBlockCount() == 1 && allocator.largestFreeBlock() == 70 && allocator.fragmentation() == 0.0f,
+            "compact: a single 70 unit free block is left");
+        expect(allocateAt(allocator, 70) == 30, "compact: the free block starts after the last allocation");
+        expect(allocator.compact().empty(), "compact: a compact space needs no moves");
+    }
+
+    // statistics: freeing every other allocation halves occupancy and leaves the free space in small pieces
+    {
+        RangeAllocator allocator(1000);
+        for (int i = 0; i < 100; i++) {
+            allocateAt(allocator, 10);
+        }
+        expect(allocator.occupancy() == 1.0f && allocator.fragmentation() == 0.0f, "statistics: full");
+        for (uint32_t offset = 0; offset < 1000; offset += 20) {
+            allocator.free(offset);
+        }
+        expect(allocator.occupancy() == 0.5f && allocator.freeBlockCount() == 50 && allocator.largestFreeBlock() == 10,
+            "statistics: half used in 50 free blocks of 10");
+        expect(std::abs(allocator.fragmentation() - 0.98f) < 1e-6f, "statistics: fragmentation 1 - 10/500");
+        expect(allocateAt(allocator, 11) == UINT32_MAX, "statistics: 500 free units can't hold 11 contiguous ones");
+        std::cout << "  fragmented: occupancy " << allocator.occupancy() << ", fragmentation " << allocator.fragmentation()
+                  << ", " << allocator.freeBlockCount() << " free blocks" << std::endl;
+        allocator.compact();
+        expect(allocator.fragmentation() == 0.0f && allocateAt(allocator, 500) == 500,
+            "statistics: compaction makes all 500 free units contiguous");
+    }
+
+    // random allocations and frees against a plain list of the live ranges: no overlaps, consistent totals
+    {
+        std::mt19937 random(42);
+        std::uniform_int_distribution<uint32_t> size(1, 64);
+        RangeAllocator allocator(4096);
+        std::map<uint32_t, uint32_t> live;
+        bool consistent = true;
+        for (int i = 0; i < 20000 && consistent; i++) {
+            if (live.empty() || random() % 2 == 0) {
+                uint32_t request = size(random);
+                uint32_t offset;
+                if (allocator.allocate(request, offset)) {
+                    live[offset] = request;
+                } else {
+                    consistent = consistent && allocator.largestFreeBlock() < request;
+                }
+            } else {
+                auto victim = std::next(live.begin(), random() % live.size());
+                allocator.free(victim->first);
+                live.erase(victim);
+            }
+            if (i % 5000 == 4999) {
+                for (const RangeMove& move : allocator.compact()) {
+                    uint32_t moved = live[move.from];
+                    live.erase(move.from);
+                    live[move.to] = moved;
+                }
+            }
+
+            uint32_t used = 0;
+            uint32_t end = 0;
+            for (const auto& range : live) {
+                consistent = consistent && range.first >= end;
+                end = range.first + range.second;
+                used += range.second;
+            }
+            consistent = consistent && end <= allocator.capacity() && used == allocator.usedSize()
+                && live.size() == allocator.allocationCount();
+        }
+        expect(consistent, "random: allocations stay disjoint and inside the capacity, totals match");
+    }
+
+    std::cout << "range allocator check: " << checks - failures << " of " << checks << " checks passed" << std::endl;
+    return failures == 0;
+}
+
+/**
+ * Times the frustum culling kernels on random spheres and boxes around the demo's starting camera, at 100k and
+ * 1M objects, and checks every SIMD kernel's visibility mask against the scalar reference.
+ */
+bool checkFrustumCulling() {
+    using Clock = std::chrono::steady_clock;
+    using FrustumCulling::Kernel;
+    const int runs = 20;
+    const Kernel kernels[] = {Kernel::Scalar, Kernel::Sse, Kernel::Avx};
+
+    Camera camera{glm::vec3(20.0f, 14.5f, 15.2f), glm::vec3(-0.6512f, -0.4769f, -0.5903f)};
+    Frustum frustum = camera.getFrustum(800.0f / 600.0f);
+
+    std::cout << "frustum culling check (" << runs << " runs, best kernel "
+              << FrustumCulling::kernelName(FrustumCulling::bestKernel()) << ")" << std::endl;
+    bool allMatch = true;
+    for (size_t count : {size_t(100000), size_t(1000000)}) {
+        // scattered through a cube around the camera as wide as the far plane is deep, so a few percent are visible
+        std::mt19937 random(42);
+        float extent = camera.getFarPlane();
+        std::uniform_real_distribution<float> offset(-extent, extent);
+        std::uniform_real_distribution<float> size(0.1f, 2.0f);
+        SphereBatch spheres;
+        AabbBatch boxes;
+        spheres.reserve(count);
+        boxes.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            glm::vec3 center = camera.getPosition() + glm::vec3(offset(random), offset(random), offset(random));
+            glm::vec3 halfSize(size(random), size(random), size(random));
+            spheres.add(center, glm::length(halfSize));
+            boxes.add(center - halfSize, center + halfSize);
+        }
+
+        VisibilityMask sphereReference;
+        VisibilityMask boxReference;
+        FrustumCulling::cullSpheres(frustum, spheres, sphereReference, Kernel::Scalar);
+        FrustumCulling::cullAabbs(frustum, boxes, boxReference, Kernel::Scalar);
+        std::cout << "  " << count << " objects, " << sphereReference.visibleCount() << " spheres and "
+                  << boxReference.visibleCount() << " boxes visible" << std::endl;
+
+        for (Kernel kernel : kernels) {
+            if (!FrustumCulling::isSupported(kernel)) {
+                std::cout << "    " << FrustumCulling::kernelName(kernel) << ": not supported by this CPU" << std::endl;
+                continue;
+            }
+            VisibilityMask sphereMask;
+            VisibilityMask boxMask;
+            double sphereTime = 0.0;
+            double boxTime = 0.0;
+            for (int run = 0; run < runs; run++) {
+                auto start = Clock::now();
+                FrustumCulling::cullSpheres(frustum, spheres, sphereMask, kernel);
+                auto middle = Clock::now();
+                FrustumCulling::cullAabbs(frustum, boxes, boxMask, kernel);
+                sphereTime += std::chrono::duration<double, std::milli>(middle - start).count();
+                boxTime += std::chrono::duration<double, std::milli>(Clock::now() - middle).count();
+            }
+            bool matches = sphereMask == sphereReference && boxMask == boxReference;
+            allMatch = allMatch && matches;
+            std::cout << "    " << FrustumCulling::kernelName(kernel) << ": spheres " << sphereTime / runs << " ms ("
+                      << sphereTime / runs * 1e6 / count << " ns/object), boxes " << boxTime / runs << " ms ("
+                      << boxTime / runs * 1e6 / count << " ns/object)" << (matches ? "" : "  MISMATCH") << std::endl;
+        }
+    }
+    if (!allMatch) {
+        std::cout << "  FAILED: a SIMD kernel disagreed with the scalar reference" << std::endl;
+    }
+    return allMatch;
+}
+
+/**
+ * Just enough of a GL driver for Shader on the CPU: every shader compiles, every program links and reports
+ * activeUniforms as its active uniforms, at their index + 1, and the glUniform calls are logged per location.
+ */
+namespace StandInGl {
+    struct ActiveUniform {
+        std::string name;
+        GLenum type;
+    };
+
+    std::vector<ActiveUniform> activeUniforms;
+    std::map<GLint, std::vector<float>> uploads;
+    size_t uploadCalls = 0;
+
+    GLuint APIENTRY createObject() { return 1; }
+    GLuint APIENTRY createShader(GLenum) { return 1; }
+    void APIENTRY shaderSource(GLuint, GLsizei, const GLchar* const*, const GLint*) {}
+    void APIENTRY ignore(GLuint) {}
+    void APIENTRY ignorePair(GLuint, GLuint) {}
+
+    // compile, link and completion status are all true
+    void APIENTRY getParameter(GLuint, GLenum parameter, GLint* value) {
+        if (parameter == GL_ACTIVE_UNIFORMS) {
+            *value = static_cast<GLint>(activeUniforms.size());
+        } else if (parameter == GL_ACTIVE_UNIFORM_MAX_LENGTH) {
+            *value = 64;
+        } else {
+            *value = GL_TRUE;
+        }
+    }
+
+    // members of struct arrays are reported one by one, "pointLights[0].position" of size 1, as GL does
+    void APIENTRY getActiveUniform(GLuint, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name) {
+        std::string uniform = activeUniforms[index].name.substr(0, bufSize - 1);
+        std::memcpy(name, uniform.c_str(), uniform.size() + 1);
+        *length = static_cast<GLsizei>(uniform.size());
+        *size = 1;
+        *type = activeUniforms[index].type;
+    }
+
+    GLint APIENTRY getUniformLocation(GLuint, const GLchar* name) {
+        auto uniform = std::find_if(activeUniforms.begin(), activeUniforms.end(), [name](const ActiveUniform& active) {
+            return active.name == name;
+        });
+        return uniform == activeUniforms.end() ? -1 : static_cast<GLint>(uniform - activeUniforms.begin()) + 1;
+    }
+
+    void APIENTRY uniform1f(GLint location, GLfloat value) {
+        uploadCalls++;
+        uploads[location] = {value};
+    }
+
+    void APIENTRY uniform3fv(GLint location, GLsizei, const GLfloat* value) {
+        uploadCalls++;
+        uploads[location] = {value[0], value[1], value[2]};
+    }
+
+    void install() {
+        glad_glCreateProgram = createObject;
+        glad_glCreateShader = createShader;
+        glad_glShaderSource = shaderSource;
+        glad_glCompileShader = ignore;
+        glad_glLinkProgram = ignore;
+        glad_glDeleteShader = ignore;
+        glad_glDeleteProgram = ignore;
+        glad_glAttachShader = ignorePair;
+        glad_glDetachShader = ignorePair;
+        glad_glGetShaderiv = getParameter;
+        glad_glGetProgramiv = getParameter;
+        glad_glGetActiveUniform = getActiveUniform;
+        glad_glGetUniformLocation = getUniformLocation;
+        glad_glUniform1f = uniform1f;
+        glad_glUniform3fv = uniform3fv;
+    }
+}
+
+/**
+ * Binds the light structs through their UniformFields to a program declaring `uniform PointLight pointLights[4]`,
+ * `uniform DirLight dirLight` and `uniform SpotLight spotLight`, whose uniforms the stand-in driver reports.
+ * One upload of the whole std::array has to set every member of every light at its own location, skip the member
+ * the compiler dropped, and uploading the same values again has to set nothing.
+ */
+bool checkUniformStructs() {
+    StandInGl::install();
+    const char* pointFields[] = {"position", "constant", "linear", "quadratic", "ambient", "diffuse", "specular"};
+    const char* directionalFields[] = {"direction", "ambient", "diffuse", "specular"};
+    const char* spotFields[] = {"position", "direction", "innerCutOff", "outerCutOff", "constant", "linear", "quadratic", "ambient", "diffuse", "specular"};
+    auto activeUniform = [](std::string name) {
+        std::string field = name.substr(name.rfind('.') + 1);
+        bool scalar = field == "constant" || field == "linear" || field == "quadratic" || field == "innerCutOff" || field == "outerCutOff";
+        return StandInGl::ActiveUniform{name, static_cast<GLenum>(scalar ? GL_FLOAT : GL_FLOAT_VEC3)};
+    };
+    // the last light's specular is unused by the shader, so the compiler dropped it
+    const std::string droppedUniform = "pointLights[3].specular";
+
+    StandInGl::activeUniforms.clear();
+    for (int light = 0; light < 4; light++) {
+        for (const char* field : pointFields) {
+            std::string uniform = "pointLights[" + std::to_string(light) + "]." + field;
+            if (uniform != droppedUniform) {
+                StandInGl::activeUniforms.push_back(activeUniform(uniform));
+            }
+        }
+    }
+    for (const char* field : directionalFields) {
+        StandInGl::activeUniforms.push_back(activeUniform(std::string("dirLight.") + field));
+    }
+    for (const char* field : spotFields) {
+        StandInGl::activeUniforms.push_back(activeUniform(std::string("spotLight.") + field));
+    }
+
+    // the sources only have to preprocess, the stand-in driver compiles nothing
+    Shader shader = Shader::submit("vertex.glsl", "texture_fragment.glsl");
+    if (!shader.wait()) {
+        std::cout << "  FAILED: the program didn't build" << std::endl;
+        return false;
+    }
+
+    UniformStruct<PointLightBlock, 4> pointLights("pointLights");
+    UniformStruct<DirectionalLightBlock> dirLight("dirLight");
+    UniformStruct<SpotLightBlock> spotLight("spotLight");
+    pointLights.resolve(shader);
+    dirLight.resolve(shader);
+    spotLight.resolve(shader);
+
+    // distinct values for every member, so one set at the wrong location shows
+    std::array<PointLightBlock, 4> lights;
+    for (int i = 0; i < 4; i++) {
+        float base = 100.0f * (i + 1);
+        lights[i].position = glm::vec3(base + 1.0f, base + 2.0f, base + 3.0f);
+        lights[i].constant = base + 4.0f;
+        lights[i].linear = base + 5.0f;
+        lights[i].quadratic = base + 6.0f;
+        lights[i].ambient = glm::vec3(base + 7.0f);
+        lights[i].diffuse = glm::vec3(base + 8.0f);
+        lights[i].specular = glm::vec3(base + 9.0f);
+    }
+    DirectionalLightBlock directional;
+    directional.direction = glm::vec3(-1.0f, -2.0f, -3.0f);
+    directional.ambient = glm::vec3(-4.0f);
+    directional.diffuse = glm::vec3(-5.0f);
+    directional.specular = glm::vec3(-6.0f);
+    SpotLightBlock spot;
+    spot.position = glm::vec3(11.0f, 12.0f, 13.0f);
+    spot.direction = glm::vec3(14.0f, 15.0f, 16.0f);
+    spot.innerCutOff = 17.0f;
+    spot.outerCutOff = 18.0f;
+    spot.constant = 19.0f;
+    spot.linear = 20.0f;
+    spot.quadratic = 21.0f;
+    spot.ambient = glm::vec3(22.0f);
+    spot.diffuse = glm::vec3(23.0f);
+    spot.specular = glm::vec3(24.0f);
+
+    StandInGl::uploads.clear();
+    StandInGl::uploadCalls = 0;
+    pointLights.upload(shader, lights);
+    dirLight.upload(shader, directional);
+    spotLight.upload(shader, spot);
+
+    size_t failures = 0;
+    auto expect = [&failures](const std::string& uniform, std::vector<float> values) {
+        GLint location = StandInGl::getUniformLocation(0, uniform.c_str());
+        if (location < 0) {
+            return;
+        }
+        auto upload = StandInGl::uploads.find(location);
+        if (upload == StandInGl::uploads.end() || upload->second != values) {
+            if (failures++ < 5) {
+                std::cout << "  FAILED: " << uniform << " wasn't set to its value" << std::endl;
+            }
+        }
+    };
+    auto vec3 = [](const glm::vec3& v) {
+        return std::vector<float>{v.x, v.y, v.z};
+    };
+    for (int i = 0; i < 4; i++) {
+        std::string light = "pointLights[" + std::to_string(i) + "].";
+        expect(light + "position", vec3(lights[i].position));
+        expect(light + "constant", {lights[i].constant});
+        expect(light + "linear", {lights[i].linear});
+        expect(light + "quadratic", {lights[i].quadratic});
+        expect(light + "ambient", vec3(lights[i].ambient));
+        expect(light + "diffuse", vec3(lights[i].diffuse));
+        expect(light + "specular", vec3(lights[i].specular));
+    }
+    expect("dirLight.direction", vec3(directional.direction));
+    expect("dirLight.ambient", vec3(directional.ambient));
+    expect("dirLight.diffuse", vec3(directional.diffuse));
+    expect("dirLight.specular", vec3(directional.specular));
+    expect("spotLight.position", vec3(spot.position));
+    expect("spotLight.direction", vec3(spot.direction));
+    expect("spotLight.innerCutOff", {spot.innerCutOff});
+    expect("spotLight.outerCutOff", {spot.outerCutOff});
+    expect("spotLight.constant", {spot.constant});
+    expect("spotLight.linear", {spot.linear});
+    expect("spotLight.quadratic", {spot.quadratic});
+    expect("spotLight.ambient", vec3(spot.ambient));
+    expect("spotLight.diffuse", vec3(spot.diffuse));
+    expect("spotLight.specular", vec3(spot.specular));
+
+    size_t firstCalls = StandInGl::uploadCalls;
+    if (firstCalls != StandInGl::activeUniforms.size() || pointLights.handle(3, 6).location != -1) {
+        std::cout << "  FAILED: " << firstCalls << " uniforms set for " << StandInGl::activeUniforms.size()
+                  << " active ones, the dropped member has to resolve to -1 and be skipped" << std::endl;
+        failures++;
+    }
+
+    // unchanged values are skipped, a changed member is the only one set
+    pointLights.upload(shader, lights);
+    dirLight.upload(shader, directional);
+    spotLight.upload(shader, spot);
+    size_t repeatCalls = StandInGl::uploadCalls - firstCalls;
+    lights[2].diffuse = glm::vec3(0.5f);
+    pointLights.upload(shader, lights);
+    size_t changedCalls = StandInGl::uploadCalls - firstCalls - repeatCalls;
+    expect("pointLights[2].diffuse", vec3(lights[2].diffuse));
+    if (repeatCalls != 0 || changedCalls != 1) {
+        std::cout << "  FAILED: uploading unchanged values set " << repeatCalls << " uniforms, one changed member set "
+                  << changedCalls << std::endl;
+        failures++;
+    }
+
+    std::cout << "uniform struct check: " << firstCalls << " light members set through "
+              << pointLights.fieldCount * pointLights.elementCount + dirLight.fieldCount + spotLight.fieldCount
+              << " resolved handles, " << failures << " failed" << std::endl;
+    return failures == 0;
+}
+
+struct Check {
+    const char* name;
+    bool (*run)();
+};
+
+const Check checks[] = {
+    {"mesh-conversion", checkMeshConversion},
+    {"texture-decode", checkTextureDecode},
+    {"quantization", checkQuantization},
+    {"range-allocator", checkRangeAllocator},
+    {"uniform-struct", checkUniformStructs},
+    {"frustum-culling", checkFrustumCulling}
+};
+
+int main(int argc, char* argv[]) {
+    std::vector<const Check*> selected;
+    for (int i = 1; i < argc; i++) {
+        std::string name = argv[i];
+        auto check = std::find_if(std::begin(checks), std::end(checks), [&name](const Check& c) { return name == c.name; });
+        if (check == std::end(checks)) {
+            std::cout << "usage: checks [check]..., the checks are:";
+            for (const Check& c : checks) {
+                std::cout << " " << c.name;
+            }
+            std::cout << std::endl;
+            return 1;
+        }
+        selected.push_back(&*check);
+    }
+    if (selected.empty()) {
+        for (const Check& check : checks) {
+            selected.push_back(&check);
+        }
+    }
+
+    size_t failed = 0;
+    for (const Check* check : selected) {
+        if (!check->run()) {
+            failed++;
+        }
+    }
+    if (failed > 0) {
+        std::cout << failed << " of " << selected.size() << " checks FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "all " << selected.size() << " checks passed" << std::endl;
+    return 0;
+}
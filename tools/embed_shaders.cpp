@@ -0,0 +1,119 @@
+/**
+ * Build step: writes a header with the given shader files as constexpr strings, sorted by file name
+ * so EmbeddedShaders::find can binary search them. Runs on the build machine, see the Makefile.
+ *
+ * usage: embed_shaders <output header> <shader file>...
+ */
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct ShaderFile {
+    std::string name;
+    std::string source;
+};
+
+// the contents as a C++ string literal, one literal per source line so the header stays readable
+std::string toLiteral(const std::string& source) {
+    std::string literal = "\"";
+    for (size_t i = 0; i < source.size(); i++) {
+        unsigned char c = static_cast<unsigned char>(source[i]);
+        switch (c) {
+            case '\\': literal += "\\\\"; break;
+            case '"': literal += "\\\""; break;
+            case '\t': literal += "\\t"; break;
+            case '\r': literal += "\\r"; break;
+            case '\n':
+                literal += "\\n\"";
+                if (i + 1 < source.size()) {
+                    literal += "\n        \"";
+                } else {
+                    return literal;
+                }
+                break;
+            default:
+                if (c < 0x20 || c >= 0x7F || c == '?') {
+                    // three digit octal can't run into a following digit, '?' avoids trigraphs
+                    const char digits[] = {'\\', char('0' + (c >> 6)), char('0' + ((c >> 3) & 7)), char('0' + (c & 7)), '\0'};
+                    literal += digits;
+                } else {
+                    literal += static_cast<char>(c);
+                }
+        }
+    }
+    return literal + "\"";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cout << "usage: embed_shaders <output header> <shader file>..." << std::endl;
+        return 1;
+    }
+
+    std::vector<ShaderFile> files;
+    for (int i = 2; i < argc; i++) {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file) {
+            std::cout << "ERROR::EMBED_SHADERS::FILE_NOT_SUCCESSFULLY_READ: " << argv[i] << std::endl;
+            return 1;
+        }
+        std::stringstream stream;
+        stream << file.rdbuf();
+        files.push_back({std::filesystem::path(argv[i]).filename().string(), stream.str()});
+    }
+    std::sort(files.begin(), files.end(), [](const ShaderFile& a, const ShaderFile& b) { return a.name < b.name; });
+    for (size_t i = 1; i < files.size(); i++) {
+        if (files[i].name == files[i - 1].name) {
+            std::cout << "ERROR::EMBED_SHADERS::DUPLICATE_NAME: " << files[i].name << std::endl;
+            return 1;
+        }
+    }
+
+    std::ostringstream header;
+    header << "// generated by tools/embed_shaders.cpp, don't edit\n"
+           << "#pragma once\n\n"
+           << "#include <cstddef>\n"
+           << "#include <string_view>\n\n"
+           << "namespace EmbeddedShaders {\n\n"
+           << "struct File {\n"
+           << "    std::string_view name;\n"
+           << "    std::string_view source;\n"
+           << "};\n\n"
+           << "// sorted by name\n"
+           << "inline constexpr File files[] = {\n";
+    for (const ShaderFile& file : files) {
+        // the explicit size keeps any embedded nulls
+        header << "    {" << toLiteral(file.name) << ", std::string_view(\n        "
+               << toLiteral(file.source) << ", " << file.source.size() << ")},\n";
+    }
+    header << "};\n\n"
+           << "inline constexpr size_t fileCount = " << files.size() << ";\n\n"
+           << "// the file named name, nullptr if it wasn't embedded\n"
+           << "constexpr const File* find(std::string_view name) {\n"
+           << "    size_t first = 0;\n"
+           << "    size_t last = fileCount;\n"
+           << "    while (first < last) {\n"
+           << "        size_t middle = first + (last - first) / 2;\n"
+           << "        if (files[middle].name < name) {\n"
+           << "            first = middle + 1;\n"
+           << "        } else {\n"
+           << "            last = middle;\n"
+           << "        }\n"
+           << "    }\n"
+           << "    return first < fileCount && files[first].name == name ? &files[first] : nullptr;\n"
+           << "}\n\n"
+           << "} // namespace EmbeddedShaders\n";
+
+    std::ofstream output(argv[1], std::ios::binary);
+    output << header.str();
+    if (!output) {
+        std::cout << "ERROR::EMBED_SHADERS::FILE_NOT_SUCCESSFULLY_WRITTEN: " << argv[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}